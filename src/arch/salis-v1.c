@@ -18,6 +18,10 @@ bool proc_is_live(const Core *core, u64 pix);
 const Proc *proc_get(const Core *core, u64 pix);
 Proc *proc_fetch(Core *core, u64 pix);
 
+#if HEAT_MAPS == 1
+void core_heat(Core *core, int kind, u64 addr);
+#endif
+
 #define INST_LIST    \
     INST(noop, L' ') \
     INST(nop0, L'0') \
@@ -278,6 +282,11 @@ bool _seek(Core *core, u64 pix, bool fwrd) {
     u8    next = _get_inst(core, proc->ip + 1);
 
     if (!_is_key(next)) {
+#if OPCODE_STATS == 1
+        // seeks without a key give up, other steps are still searching
+        core->opce[OPEV_SEEK]++;
+#endif
+
         _increment_ip(core, pix);
         return false;
     }
@@ -447,6 +456,10 @@ void _alloc(Core *core, u64 pix, bool fwrd) {
 
     // sp collided with another allocated block, clear and try again
     if (mvec_is_alloc(core, proc->sp)) {
+#if OPCODE_STATS == 1
+        core->opce[OPEV_ALLC]++;
+#endif
+
         if (proc->mb1s) {
             _free_child_memory_of(core, pix);
         }
@@ -703,6 +716,14 @@ void _write(Core *core, u64 pix) {
     } else {
         if (_is_writeable_by(core, *regs[0], pix)) {
             mvec_set_inst(core, *regs[0], *regs[1] % INST_CAPS);
+
+#if HEAT_MAPS == 1
+            core_heat(core, HEAT_WRTE, *regs[0]);
+#endif
+        } else {
+#if OPCODE_STATS == 1
+            core->opce[OPEV_WRTE]++;
+#endif
         }
 
         _increment_ip(core, pix);
@@ -743,6 +764,10 @@ void arch_proc_step(Core *core, u64 pix) {
     Proc *proc = proc_fetch(core, pix);
     u8    inst = _get_inst(core, proc->ip);
 
+#if OPCODE_STATS == 1
+    core->opci[inst]++;
+#endif
+
     switch (inst) {
     case jmpb:
         if (_seek(core, pix, false)) {
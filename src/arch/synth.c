@@ -0,0 +1,378 @@
+// Project: Salis
+// Author:  Paul Oliver
+// Email:   contact@pauloliver.dev
+
+/*
+ * Defines a synthetic workload architecture for benchmarking the Salis
+ * engine. Processes don't evolve; instead, each one draws operations from a
+ * weighted mix of memory reads, memory writes, child block allocations,
+ * splits and IPC-visible writes. All addresses fall within a window of
+ * SYNTH_LOCALITY bytes around the process' memory block. Each process keeps
+ * its own PRNG state, so runs are fully reproducible.
+ */
+
+bool mvec_is_alloc(const Core *core, u64 pix);
+void mvec_alloc(Core *core, u64 addr);
+void mvec_free(Core *core, u64 addr);
+u8 mvec_get_inst(const Core *core, u64 addr);
+void mvec_set_inst(Core *core, u64 addr, u8 inst);
+bool mvec_is_proc_owner(const Core *core, u64 addr, u64 pix);
+void proc_new(Core *core, const Proc *proc);
+bool proc_is_live(const Core *core, u64 pix);
+const Proc *proc_get(const Core *core, u64 pix);
+Proc *proc_fetch(Core *core, u64 pix);
+void core_push_ipcm(Core *core, u8 inst, u64 addr);
+
+#if HEAT_MAPS == 1
+void core_heat(Core *core, int kind, u64 addr);
+#endif
+
+#ifndef SYNTH_MIX_READ
+#define SYNTH_MIX_READ (8)
+#endif
+
+#ifndef SYNTH_MIX_WRTE
+#define SYNTH_MIX_WRTE (4)
+#endif
+
+#ifndef SYNTH_MIX_ALLC
+#define SYNTH_MIX_ALLC (2)
+#endif
+
+#ifndef SYNTH_MIX_SPLT
+#define SYNTH_MIX_SPLT (1)
+#endif
+
+#ifndef SYNTH_MIX_IPCM
+#define SYNTH_MIX_IPCM (1)
+#endif
+
+#ifndef SYNTH_LOCALITY
+#define SYNTH_LOCALITY (0x100ul)
+#endif
+
+#define SYNTH_BLOCK_SIZE (0x40)
+#define SYNTH_MIX_TOTAL  (SYNTH_MIX_READ + SYNTH_MIX_WRTE + SYNTH_MIX_ALLC + SYNTH_MIX_SPLT + SYNTH_MIX_IPCM)
+
+#if SYNTH_MIX_TOTAL == 0
+#error Synthetic workload mix must have at least one non-zero weight
+#endif
+
+#define PROC_FIELDS       \
+    PROC_FIELD(u64, ip)   \
+    PROC_FIELD(u64, sp)   \
+    PROC_FIELD(u64, mb0a) \
+    PROC_FIELD(u64, mb0s) \
+    PROC_FIELD(u64, mb1a) \
+    PROC_FIELD(u64, mb1s) \
+    PROC_FIELD(u64, rngs) \
+    PROC_FIELD(u64, racc)
+
+struct Proc {
+#define PROC_FIELD(type, name) type name;
+    PROC_FIELDS
+#undef PROC_FIELD
+};
+
+#define MNEMONIC_BUFF_SIZE (0x10)
+
+const wchar_t *g_arch_byte_symbols = (
+    L"⠀⠁⠂⠃⠄⠅⠆⠇⡀⡁⡂⡃⡄⡅⡆⡇⠈⠉⠊⠋⠌⠍⠎⠏⡈⡉⡊⡋⡌⡍⡎⡏⠐⠑⠒⠓⠔⠕⠖⠗⡐⡑⡒⡓⡔⡕⡖⡗⠘⠙⠚⠛⠜⠝⠞⠟⡘⡙⡚⡛⡜⡝⡞⡟"
+    L"⠠⠡⠢⠣⠤⠥⠦⠧⡠⡡⡢⡣⡤⡥⡦⡧⠨⠩⠪⠫⠬⠭⠮⠯⡨⡩⡪⡫⡬⡭⡮⡯⠰⠱⠲⠳⠴⠵⠶⠷⡰⡱⡲⡳⡴⡵⡶⡷⠸⠹⠺⠻⠼⠽⠾⠿⡸⡹⡺⡻⡼⡽⡾⡿"
+    L"⢀⢁⢂⢃⢄⢅⢆⢇⣀⣁⣂⣃⣄⣅⣆⣇⢈⢉⢊⢋⢌⢍⢎⢏⣈⣉⣊⣋⣌⣍⣎⣏⢐⢑⢒⢓⢔⢕⢖⢗⣐⣑⣒⣓⣔⣕⣖⣗⢘⢙⢚⢛⢜⢝⢞⢟⣘⣙⣚⣛⣜⣝⣞⣟"
+    L"⢠⢡⢢⢣⢤⢥⢦⢧⣠⣡⣢⣣⣤⣥⣦⣧⢨⢩⢪⢫⢬⢭⢮⢯⣨⣩⣪⣫⣬⣭⣮⣯⢰⢱⢲⢳⢴⢵⢶⢷⣰⣱⣲⣳⣴⣵⣶⣷⢸⢹⢺⢻⢼⢽⢾⢿⣸⣹⣺⣻⣼⣽⣾⣿"
+);
+
+u64 arch_proc_mb0_addr(const Core *core, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+    return proc_get(core, pix)->mb0a;
+}
+
+u64 arch_proc_mb0_size(const Core *core, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+    return proc_get(core, pix)->mb0s;
+}
+
+u64 arch_proc_mb1_addr(const Core *core, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+    return proc_get(core, pix)->mb1a;
+}
+
+u64 arch_proc_mb1_size(const Core *core, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+    return proc_get(core, pix)->mb1s;
+}
+
+u64 arch_proc_ip_addr(const Core *core, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+    return proc_get(core, pix)->ip;
+}
+
+u64 arch_proc_sp_addr(const Core *core, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+    return proc_get(core, pix)->sp;
+}
+
+u64 arch_proc_slice(const Core *core, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+
+    (void)core;
+    (void)pix;
+
+    return 1;
+}
+
+void _free_memory_block(Core *core, u64 addr, u64 size) {
+    assert(core);
+    assert(size);
+
+    for (u64 i = 0; i < size; ++i) {
+        mvec_free(core, addr + i);
+    }
+}
+
+void arch_on_proc_kill(Core *core) {
+    assert(core);
+    assert(core->pnum > 1);
+
+    Proc *pfst = proc_fetch(core, core->pfst);
+
+    _free_memory_block(core, pfst->mb0a, pfst->mb0s);
+
+    if (pfst->mb1s) {
+        _free_memory_block(core, pfst->mb1a, pfst->mb1s);
+    }
+
+    memcpy(pfst, &g_dead_proc, sizeof(Proc));
+}
+
+u64 _next_rand(Proc *proc) {
+    assert(proc);
+
+    // xorshift64, seeded per process
+    u64 x = proc->rngs;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+
+    proc->rngs = x;
+
+    return x;
+}
+
+u64 _local_addr(Proc *proc) {
+    assert(proc);
+
+    u64 offs = _next_rand(proc) % SYNTH_LOCALITY;
+    u64 addr = proc->mb0a + offs - (SYNTH_LOCALITY / 2);
+
+    return addr % MVEC_SIZE;
+}
+
+#if ACTION == ACT_BENCH || ACTION == ACT_NEW
+void arch_anc_init(Core *core, u64 size) {
+    assert(core);
+
+#if ANC_HALF == 1
+    u64 addr = U64_HALF;
+#else
+    u64 addr = 0;
+#endif
+
+    for (int i = 0; i < ANC_CLONES; ++i) {
+        u64 addr_clone = (addr + ((MVEC_SIZE / ANC_CLONES) * i)) % MVEC_SIZE;
+
+        Proc *panc = proc_fetch(core, i);
+
+        // without a compiled ancestor, a blank block is allocated instead
+        if (!size) {
+            for (u64 j = 0; j < SYNTH_BLOCK_SIZE; ++j) {
+                mvec_alloc(core, addr_clone + j);
+            }
+        }
+
+        panc->mb0a = addr_clone;
+        panc->mb0s = size ? size : SYNTH_BLOCK_SIZE;
+        panc->ip   = addr_clone;
+        panc->sp   = addr_clone;
+        panc->rngs = (0x9e3779b97f4a7c15 * (i + 1) + core->muta[0]) | 1;
+    }
+}
+#endif
+
+void _read(Core *core, Proc *proc) {
+    assert(core);
+    assert(proc);
+
+    proc->racc += mvec_get_inst(core, _local_addr(proc));
+}
+
+void _write(Core *core, u64 pix, Proc *proc) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+    assert(proc);
+
+    u64 addr = _local_addr(proc);
+    u8  inst = _next_rand(proc) % INST_CAPS;
+
+    if (!mvec_is_alloc(core, addr) || mvec_is_proc_owner(core, addr, pix)) {
+        mvec_set_inst(core, addr, inst);
+
+#if HEAT_MAPS == 1
+        core_heat(core, HEAT_WRTE, addr);
+#endif
+    } else {
+#if OPCODE_STATS == 1
+        core->opce[OPEV_WRTE]++;
+#endif
+    }
+}
+
+void _alloc(Core *core, Proc *proc) {
+    assert(core);
+    assert(proc);
+
+    if (proc->mb1s) {
+        return;
+    }
+
+    // children are as large as their parents
+    u64 addr = proc->sp;
+    u64 size = proc->mb0s;
+
+    if (addr + size > MVEC_SIZE) {
+        proc->sp = _local_addr(proc);
+        return;
+    }
+
+    for (u64 i = 0; i < size; ++i) {
+        if (mvec_is_alloc(core, addr + i)) {
+#if OPCODE_STATS == 1
+            core->opce[OPEV_ALLC]++;
+#endif
+
+            proc->sp = _local_addr(proc);
+            return;
+        }
+    }
+
+    for (u64 i = 0; i < size; ++i) {
+        mvec_alloc(core, addr + i);
+    }
+
+    proc->mb1a = addr;
+    proc->mb1s = size;
+}
+
+void _split(Core *core, Proc *proc) {
+    assert(core);
+    assert(proc);
+
+    if (!proc->mb1s) {
+        return;
+    }
+
+    Proc child = {0};
+
+    child.ip   = proc->mb1a;
+    child.sp   = proc->mb1a;
+    child.mb0a = proc->mb1a;
+    child.mb0s = proc->mb1s;
+    child.rngs = _next_rand(proc) | 1;
+
+    proc->mb1a = 0;
+    proc->mb1s = 0;
+    proc->sp   = _local_addr(proc);
+
+    // 'proc' may be reallocated when the process ring grows
+    proc_new(core, &child);
+}
+
+void _ipcm(Core *core, Proc *proc) {
+    assert(core);
+    assert(proc);
+
+    u64 addr = _local_addr(proc);
+    u8  inst = _next_rand(proc) % INST_CAPS;
+
+    core_push_ipcm(core, inst, addr);
+}
+
+void arch_proc_step(Core *core, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+
+    Proc *proc = proc_fetch(core, pix);
+    u64   pick = _next_rand(proc) % SYNTH_MIX_TOTAL;
+
+    proc->ip = proc->mb0a + ((proc->ip - proc->mb0a + 1) % proc->mb0s);
+
+    if (pick < SYNTH_MIX_READ) {
+        _read(core, proc);
+        return;
+    }
+
+    pick -= SYNTH_MIX_READ;
+
+    if (pick < SYNTH_MIX_WRTE) {
+        _write(core, pix, proc);
+        return;
+    }
+
+    pick -= SYNTH_MIX_WRTE;
+
+    if (pick < SYNTH_MIX_ALLC) {
+        _alloc(core, proc);
+        return;
+    }
+
+    pick -= SYNTH_MIX_ALLC;
+
+    if (pick < SYNTH_MIX_SPLT) {
+        _split(core, proc);
+        return;
+    }
+
+    _ipcm(core, proc);
+}
+
+#ifndef NDEBUG
+void arch_validate_proc(const Core *core, u64 pix) {
+    assert(core);
+
+    const Proc *proc = proc_get(core, pix);
+
+    assert(proc->mb0s);
+    assert(proc->rngs);
+
+    for (u64 i = 0; i < proc->mb0s; ++i) {
+        u64 addr = proc->mb0a + i;
+        assert(mvec_is_alloc(core, addr));
+        assert(mvec_is_proc_owner(core, addr, pix));
+    }
+
+    for (u64 i = 0; i < proc->mb1s; ++i) {
+        u64 addr = proc->mb1a + i;
+        assert(mvec_is_alloc(core, addr));
+        assert(mvec_is_proc_owner(core, addr, pix));
+    }
+}
+#endif
+
+wchar_t arch_symbol(u8 inst) {
+    return g_arch_byte_symbols[inst];
+}
+
+void arch_mnemonic(u8 inst, char *buff) {
+    assert(buff);
+
+    snprintf(buff, MNEMONIC_BUFF_SIZE, "synth %#x", inst);
+}
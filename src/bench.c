@@ -4,18 +4,62 @@
 
 /*
  * Simple benchmark test helps measure simulation speed by stepping the
- * simulator N times and printing results.
+ * simulator N times and printing results. With PERF_EVENTS, hardware events
+ * get counted on every core thread, and reported per core along with rates
+ * per simulated step.
  */
 
 #if ACTION != ACT_BENCH
 #error Using bench UI with unsupported action
 #endif
 
+#if PERF_EVENTS == 1
+void print_event(const Core *core, int prfc, u64 stps) {
+    assert(core);
+    assert(prfc < PRFC_COUNT);
+
+    if (core->prfu & (1ul << prfc)) {
+        printf("    %-14s %18s\n", g_prfc_names[prfc], "unavailable");
+        return;
+    }
+
+    printf(
+        "    %-14s %#18lx %12.3f per step\n",
+        g_prfc_names[prfc],
+        core->prfc[prfc],
+        stps ? (double)core->prfc[prfc] / stps : 0.0
+    );
+}
+
+void print_perf(int cix) {
+    const Core *core = &g_cores[cix];
+    const u64  *prfc = core->prfc;
+    const u64   unav = core->prfu;
+
+    printf("\ncore %d\n", cix);
+
+    for (int i = 0; i < PRFC_COUNT; ++i) {
+        print_event(core, i, g_steps);
+    }
+
+    if (!(unav & (1ul << PRFC_tclk)) && prfc[PRFC_tclk]) {
+        printf("    %-14s %18.0f\n", "steps/s", g_steps * 1e9 / prfc[PRFC_tclk]);
+    }
+
+    if (!(unav & (1ul << PRFC_cycs | 1ul << PRFC_inst)) && prfc[PRFC_cycs]) {
+        printf("    %-14s %18.3f\n", "IPC", (double)prfc[PRFC_inst] / prfc[PRFC_cycs]);
+    }
+}
+#endif
+
 int main() {
     printf("Salis Benchmark Test\n\n");
 
     salis_init("", SEED);
+
+    u64 beg = salis_clock_ns();
     salis_step(BENCH_STEPS);
+    u64 end = salis_clock_ns();
 
     printf("seed        => %#lx\n", SEED);
     printf("g_steps     => %#lx\n", g_steps);
@@ -36,6 +80,10 @@ int main() {
         printf("core %d psli => %#lx\n", i, g_cores[i].psli);
         printf("core %d ncyc => %#lx\n", i, g_cores[i].ncyc);
         printf("core %d ivpt => %#lx\n", i, g_cores[i].ivpt);
+#if STATE_DIGEST == 1
+        printf("core %d mvhs => %#lx\n", i, g_cores[i].mvhs);
+        printf("core %d ivhs => %#lx\n", i, g_cores[i].ivhs);
+#endif
         putchar('\n');
 
         for (int j = 0; j < 32; ++j) {
@@ -45,5 +93,41 @@ int main() {
         putchar('\n');
     }
 
+#if OPCODE_STATS == 1
+    putchar('\n');
+    salis_opcs_print();
+#endif
+
+#if PHASE_TIMING == 1
+    putchar('\n');
+    salis_phase_print();
+#endif
+
+#if HEAT_MAPS == 1
+    putchar('\n');
+    salis_heat_print();
+#endif
+
+#if GENOME_CENSUS == 1
+    putchar('\n');
+    salis_cens_print();
+#endif
+
+    putchar('\n');
+    salis_sbar_print();
+
+    putchar('\n');
+    salis_mems_print();
+
+    putchar('\n');
+    printf("time        => %.3f s\n", (end - beg) / 1e9);
+    printf("steps/s     => %.0f\n", g_steps * 1e9 / (end - beg));
+
+#if PERF_EVENTS == 1
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        print_perf(i);
+    }
+#endif
+
     salis_free();
 }
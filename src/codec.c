@@ -0,0 +1,233 @@
+// Project: Salis
+// Author:  Paul Oliver
+// Email:   contact@pauloliver.dev
+
+/*
+ * This module implements a small, self-contained LZ77 style codec, used to
+ * compress save files. A packed stream is a list of sequences, each made of
+ * a run of literal bytes followed by a back-reference into the previously
+ * decoded output. All lengths and offsets are stored as LEB128 varints, so
+ * the huge zero-filled (or otherwise repeated) regions typical of memory
+ * buffers collapse into a handful of bytes. A zero offset ends the stream.
+ */
+
+#define CODEC_HASH_POW  (16)
+#define CODEC_HASH_SIZE (1ul << CODEC_HASH_POW)
+#define CODEC_MIN_MATCH (4)
+#define CODEC_SKIP_POW  (6)
+
+u64 codec_bound(u64 size) {
+    // worst case is a single run of literals, prefixed by a few varints
+    return size + (size >> 6) + 0x20;
+}
+
+u64 codec_put_varint(u8 *dst, u64 value) {
+    assert(dst);
+
+    u64 i = 0;
+
+    while (value >= 0x80) {
+        dst[i++] = (u8)(value | 0x80);
+        value >>= 7;
+    }
+
+    dst[i++] = (u8)value;
+
+    return i;
+}
+
+// Reads a varint at 'ip' (advancing it) from a stream of 'csize' bytes.
+// Returns false if the varint is cut short or overflows 64 bits.
+bool codec_get_varint(const u8 *src, u64 csize, u64 *ip, u64 *value) {
+    assert(src);
+    assert(ip);
+    assert(value);
+
+    int s = 0;
+
+    *value = 0;
+
+    while (*ip < csize && s < 64) {
+        u8 byte = src[(*ip)++];
+
+        *value |= (u64)(byte & 0x7f) << s;
+        s      += 7;
+
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+u64 codec_varint_size(u64 value) {
+    u64 size = 1;
+
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+
+    return size;
+}
+
+uint32_t codec_read32(const u8 *src) {
+    uint32_t value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+u64 codec_hash(uint32_t value) {
+    return (u64)((value * 2654435761u) >> (32 - CODEC_HASH_POW));
+}
+
+u64 codec_match_len(const u8 *src, u64 size, u64 ref, u64 pos) {
+    assert(src);
+    assert(ref < pos);
+
+    u64 len = 0;
+
+    // compare a word at a time first, then finish byte by byte
+    while (pos + len + sizeof(u64) <= size) {
+        u64 a, b;
+
+        memcpy(&a, &src[ref + len], sizeof(u64));
+        memcpy(&b, &src[pos + len], sizeof(u64));
+
+        if (a != b) {
+            break;
+        }
+
+        len += sizeof(u64);
+    }
+
+    while (pos + len < size && src[ref + len] == src[pos + len]) {
+        len++;
+    }
+
+    return len;
+}
+
+u64 codec_put_sequence(u8 *dst, const u8 *lits, u64 llen, u64 offs, u64 mlen) {
+    assert(dst);
+
+    u64 op = codec_put_varint(dst, llen);
+
+    memcpy(&dst[op], lits, llen);
+    op += llen;
+    op += codec_put_varint(&dst[op], offs);
+
+    if (offs) {
+        op += codec_put_varint(&dst[op], mlen);
+    }
+
+    return op;
+}
+
+// Compresses 'size' bytes from 'src' into 'dst', which must be able to hold
+// at least 'codec_bound(size)' bytes. Returns the packed size.
+u64 codec_pack(const u8 *src, u64 size, u8 *dst) {
+    assert(src || !size);
+    assert(dst);
+
+    // positions are stored off by one, so that zero means empty
+    u64 *htab = calloc(CODEC_HASH_SIZE, sizeof(u64));
+
+    assert(htab);
+
+    u64 ip = 0;
+    u64 op = 0;
+    u64 an = 0;
+
+    while (ip + CODEC_MIN_MATCH * 2 <= size) {
+        uint32_t seq  = codec_read32(&src[ip]);
+        u64      hidx = codec_hash(seq);
+        u64      cand = htab[hidx];
+
+        htab[hidx] = ip + 1;
+
+        if (cand && codec_read32(&src[cand - 1]) == seq) {
+            u64 ref  = cand - 1;
+            u64 offs = ip - ref;
+            u64 mlen = codec_match_len(src, size, ref, ip);
+
+            // only take matches which are cheaper than the literals they replace
+            if (mlen > codec_varint_size(offs) + codec_varint_size(mlen)) {
+                op += codec_put_sequence(&dst[op], &src[an], ip - an, offs, mlen);
+                ip += mlen;
+                an  = ip;
+                continue;
+            }
+        }
+
+        // skip faster through incompressible data
+        ip += 1 + ((ip - an) >> CODEC_SKIP_POW);
+    }
+
+    op += codec_put_sequence(&dst[op], &src[an], size - an, 0, 0);
+
+    free(htab);
+
+    assert(op <= codec_bound(size));
+
+    return op;
+}
+
+// Decompresses a stream of 'csize' bytes into exactly 'size' bytes at 'dst'.
+// Streams come from save files, so they are bounds checked in optimized
+// builds too. Returns false if the stream is corrupt, in which case 'dst' may
+// be partially written, but never past 'size' bytes.
+bool codec_unpack(const u8 *src, u64 csize, u8 *dst, u64 size) {
+    assert(src || !csize);
+    assert(dst || !size);
+
+    u64 ip = 0;
+    u64 op = 0;
+
+    while (true) {
+        u64 llen = 0;
+        u64 offs = 0;
+        u64 mlen = 0;
+
+        // lengths are compared against what's left, so sums never overflow
+        if (!codec_get_varint(src, csize, &ip, &llen) || llen > csize - ip || llen > size - op) {
+            return false;
+        }
+
+        memcpy(&dst[op], &src[ip], llen);
+
+        ip += llen;
+        op += llen;
+
+        if (!codec_get_varint(src, csize, &ip, &offs)) {
+            return false;
+        }
+
+        if (!offs) {
+            break;
+        }
+
+        if (!codec_get_varint(src, csize, &ip, &mlen) || offs > op || mlen > size - op) {
+            return false;
+        }
+
+        u8 *mdst = &dst[op];
+        u8 *msrc = &dst[op - offs];
+
+        if (offs == 1) {
+            memset(mdst, *msrc, mlen);
+        } else if (offs >= mlen) {
+            memcpy(mdst, msrc, mlen);
+        } else {
+            // overlapping references repeat the last 'offs' bytes
+            for (u64 i = 0; i < mlen; ++i) {
+                mdst[i] = msrc[i];
+            }
+        }
+
+        op += mlen;
+    }
+
+    return ip == csize && op == size;
+}
@@ -0,0 +1,287 @@
+// Project: Salis
+// Author:  Paul Oliver
+// Email:   contact@pauloliver.dev
+
+/*
+ * Compares two saved snapshots, either checkpoints of the same simulation or
+ * saves of two simulations sharing the same configuration. Both get loaded
+ * through the regular loader (so memory is mapped from the save files) and
+ * each core is compared on its own thread: memory vectors page by page,
+ * through the C library's vectorized memcmp, narrowing down to bytes only
+ * within pages that differ, then processes field by field, using the save
+ * header's process field table. Processes present only in the first snapshot
+ * are reported as killed, and those present only in the second as born. A
+ * summary gets printed by default, while verbose mode also lists every
+ * changed memory range and process.
+ */
+
+#if ACTION != ACT_LOAD
+#error Using diff tool with unsupported action
+#endif
+
+typedef struct Djob Djob;
+
+struct Djob {
+    const Core *ca;   // first snapshot (given by name and checkpoint)
+    const Core *cb;   // second snapshot (given by against options)
+    Thread      thread;
+    FILE       *list;   // verbose listing, written to 'ltxt'
+    char       *ltxt;
+    size_t      llen;
+    u64         mbyt;   // memory bytes changed
+    u64         mrng;   // memory ranges changed
+    u64         born;
+    u64         kill;
+    u64         chgd;   // live processes with changed fields
+    u64         flds[SAVE_FELD_CNT];   // changes per process field
+    u64         ipcm;   // IPC slots differing
+    bool        muta;   // mutator state differs
+};
+
+Djob  g_djobs[CORE_COUNT];
+Core *g_diff_cores;
+
+void djob_range(Djob *djob, u64 beg, u64 end) {
+    assert(djob);
+    assert(beg < end);
+
+    djob->mrng++;
+
+#if DIFF_VERBOSE == 1
+    fprintf(djob->list, "    mvec %#018lx-%#018lx  %#lx bytes\n", beg, end, end - beg);
+#endif
+}
+
+void djob_mvec(Djob *djob) {
+    assert(djob);
+
+    const u8 *ma   = djob->ca->mvec;
+    const u8 *mb   = djob->cb->mvec;
+    u64       rbeg = 0;
+    bool      open = false;
+
+    for (u64 addr = 0; addr < MVEC_SIZE; addr += MVEC_PAGE_SIZE) {
+        u64 size = MVEC_SIZE - addr < MVEC_PAGE_SIZE ? MVEC_SIZE - addr : MVEC_PAGE_SIZE;
+
+        // most pages are equal, so these get skipped at memcmp speed
+        if (!memcmp(&ma[addr], &mb[addr], size)) {
+            if (open) {
+                djob_range(djob, rbeg, addr);
+                open = false;
+            }
+
+            continue;
+        }
+
+        for (u64 i = addr; i < addr + size; ++i) {
+            bool diff = ma[i] != mb[i];
+
+            djob->mbyt += diff;
+
+            if (diff && !open) {
+                rbeg = i;
+                open = true;
+            } else if (!diff && open) {
+                djob_range(djob, rbeg, i);
+                open = false;
+            }
+        }
+    }
+
+    if (open) {
+        djob_range(djob, rbeg, MVEC_SIZE);
+    }
+}
+
+void djob_procs(Djob *djob) {
+    assert(djob);
+
+    const Core *ca = djob->ca;
+    const Core *cb = djob->cb;
+
+    // process indices only grow, so processes are matched by index
+    for (u64 pix = ca->pfst; pix <= ca->plst; ++pix) {
+        if (!proc_is_live(cb, pix)) {
+            djob->kill++;
+
+#if DIFF_VERBOSE == 1
+            fprintf(djob->list, "    proc %#lx killed\n", pix);
+#endif
+
+            continue;
+        }
+
+        const u8 *pa   = (const u8 *)proc_get(ca, pix);
+        const u8 *pb   = (const u8 *)proc_get(cb, pix);
+        bool      chgd = false;
+
+        for (u64 i = 0; i < SAVE_FELD_CNT; ++i) {
+            const Hfld *fld = &g_save_flds[i];
+
+            if (!memcmp(&pa[fld->offs], &pb[fld->offs], fld->size)) {
+                continue;
+            }
+
+            djob->flds[i]++;
+
+#if DIFF_VERBOSE == 1
+            if (!chgd) {
+                fprintf(djob->list, "    proc %#lx changed:", pix);
+            }
+
+            fprintf(djob->list, " %s", fld->name);
+#endif
+
+            chgd = true;
+        }
+
+        djob->chgd += chgd;
+
+#if DIFF_VERBOSE == 1
+        if (chgd) {
+            fputc('\n', djob->list);
+        }
+#endif
+    }
+
+    for (u64 pix = cb->pfst; pix <= cb->plst; ++pix) {
+        if (proc_is_live(ca, pix)) {
+            continue;
+        }
+
+        djob->born++;
+
+#if DIFF_VERBOSE == 1
+        fprintf(djob->list, "    proc %#lx born\n", pix);
+#endif
+    }
+}
+
+int djob_run(Djob *djob) {
+    assert(djob);
+
+    djob->list = open_memstream(&djob->ltxt, &djob->llen);
+
+    assert(djob->list);
+
+    djob_mvec(djob);
+    djob_procs(djob);
+
+    const Core *ca = djob->ca;
+    const Core *cb = djob->cb;
+
+    djob->muta = memcmp(ca->muta, cb->muta, sizeof(ca->muta)) != 0;
+
+    for (u64 i = 0; i < SYNC_INTERVAL; ++i) {
+        djob->ipcm += ca->iviv[i] != cb->iviv[i] || ca->ivav[i] != cb->ivav[i];
+    }
+
+    fclose(djob->list);
+
+    return 0;
+}
+
+void print_field(const char *name, u64 a, u64 b) {
+    assert(name);
+
+    if (a == b) {
+        printf("    %-6s %#lx\n", name, a);
+    } else {
+        printf("    %-6s %#lx -> %#lx\n", name, a, b);
+    }
+}
+
+void print_core(int cix) {
+    const Djob *djob = &g_djobs[cix];
+    const Core *ca   = djob->ca;
+    const Core *cb   = djob->cb;
+
+    printf("\ncore %d\n", cix);
+
+    print_field("pnum", ca->pnum, cb->pnum);
+    print_field("pfst", ca->pfst, cb->pfst);
+    print_field("plst", ca->plst, cb->plst);
+    print_field("mall", ca->mall, cb->mall);
+    print_field("ncyc", ca->ncyc, cb->ncyc);
+    print_field("ivpt", ca->ivpt, cb->ivpt);
+
+    printf("    mvec   %#lx bytes changed in %#lx ranges\n", djob->mbyt, djob->mrng);
+    printf("    procs  %#lx born, %#lx killed, %#lx changed\n", djob->born, djob->kill, djob->chgd);
+
+    for (u64 i = 0; i < SAVE_FELD_CNT; ++i) {
+        if (djob->flds[i]) {
+            printf("           %#lx with changed %s\n", djob->flds[i], g_save_flds[i].name);
+        }
+    }
+
+    printf("    ipcm   %#lx slots differ\n", djob->ipcm);
+    printf("    muta   %s\n", djob->muta ? "differs" : "same");
+
+    if (djob->llen) {
+        fwrite(djob->ltxt, sizeof(char), djob->llen, stdout);
+    }
+}
+
+int main() {
+    u64 beg = salis_clock_ns();
+
+    // the second snapshot gets its own page aligned cores, loaded first, so
+    // that globals describe the first one once both are in place
+    g_diff_cores = mmap(NULL, sizeof(Core) * CORE_COUNT, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    assert(g_diff_cores != MAP_FAILED);
+
+#ifdef DIFF_STEP
+    salis_load_checkpoint(DIFF_PATH, DIFF_STEP, g_diff_cores);
+#else
+    salis_load_file(DIFF_PATH, DIFF_PATH, g_diff_cores);
+#endif
+
+#if LOAD_QUICK == 0
+    salis_load_verify(DIFF_PATH, g_diff_cores);
+#endif
+
+    u64 stpb = g_steps;
+
+    salis_load();
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        g_djobs[i].ca = &g_cores[i];
+        g_djobs[i].cb = &g_diff_cores[i];
+        thrd_create(&g_djobs[i].thread, (thrd_start_t)djob_run, &g_djobs[i]);
+    }
+
+    u64 mbyt = 0;
+    u64 born = 0;
+    u64 kill = 0;
+    u64 chgd = 0;
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        thrd_join(g_djobs[i].thread, NULL);
+
+        mbyt += g_djobs[i].mbyt;
+        born += g_djobs[i].born;
+        kill += g_djobs[i].kill;
+        chgd += g_djobs[i].chgd;
+    }
+
+    printf("simulation '%s' at step %#lx against '%s' at step %#lx\n", SIM_PATH, g_steps, DIFF_PATH, stpb);
+    printf("%#lx bytes changed, %#lx processes born, %#lx killed, %#lx changed, ", mbyt, born, kill, chgd);
+    printf("compared in %.3f s\n", (salis_clock_ns() - beg) / 1e9);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        print_core(i);
+        free(g_djobs[i].ltxt);
+    }
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        free(g_diff_cores[i].pvec);
+        free(g_diff_cores[i].iviv);
+        free(g_diff_cores[i].ivav);
+    }
+
+    munmap(g_diff_cores, sizeof(Core) * CORE_COUNT);
+    salis_free();
+
+    return 0;
+}
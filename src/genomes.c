@@ -0,0 +1,260 @@
+// Project: Salis
+// Author:  Paul Oliver
+// Email:   contact@pauloliver.dev
+
+/*
+ * Lists the genotypes living in a saved simulation. The save gets loaded as
+ * usual (so memory is mapped, and only pages holding genomes are ever read),
+ * then each core's processes are walked on their own thread, deduplicating
+ * the genomes found in their first memory blocks through a hash table. Tables
+ * are merged once all threads finish and the most common genotypes are
+ * listed along with their disassembly. Genome hashes match the ones found in
+ * phylogeny logs.
+ */
+
+#if ACTION != ACT_LOAD
+#error Using genomes tool with unsupported action
+#endif
+
+#define GTAB_INIT_POW (10)
+
+typedef struct Gjob Gjob;
+typedef struct Gtab Gtab;
+typedef struct Gtyp Gtyp;
+
+// A distinct genome, located through one of its instances
+struct Gtyp {
+    u64 hash;
+    u64 size;
+    u64 addr;
+    u64 core;
+    u64 count;
+};
+
+// Open addressing hash table of genotypes, with empty slots having no count
+struct Gtab {
+    Gtyp *data;
+    u64   cap;
+    u64   cnt;
+};
+
+struct Gjob {
+    const Core *core;
+    Thread      thread;
+    Gtab        gtab;
+};
+
+Gjob g_gjobs[CORE_COUNT];
+Gtab g_gtab;
+
+bool gtyp_equal(const Gtyp *a, const Gtyp *b) {
+    assert(a);
+    assert(b);
+
+    if (a->hash != b->hash || a->size != b->size) {
+        return false;
+    }
+
+    const Core *ca = &g_cores[a->core];
+    const Core *cb = &g_cores[b->core];
+
+    for (u64 i = 0; i < a->size; ++i) {
+        if (mvec_get_inst(ca, a->addr + i) != mvec_get_inst(cb, b->addr + i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int gtyp_compare(const void *a, const void *b) {
+    const Gtyp *ga = a;
+    const Gtyp *gb = b;
+
+    // most common first, ties broken by hash so listings are reproducible
+    if (ga->count != gb->count) {
+        return ga->count > gb->count ? -1 : 1;
+    }
+
+    if (ga->hash != gb->hash) {
+        return ga->hash < gb->hash ? -1 : 1;
+    }
+
+    return 0;
+}
+
+void gtab_init(Gtab *gtab, u64 cap) {
+    assert(gtab);
+    assert(cap && !(cap & (cap - 1)));
+
+    gtab->data = calloc(cap, sizeof(Gtyp));
+    gtab->cap  = cap;
+    gtab->cnt  = 0;
+
+    assert(gtab->data);
+}
+
+void gtab_free(Gtab *gtab) {
+    assert(gtab);
+
+    free(gtab->data);
+
+    gtab->data = NULL;
+    gtab->cap  = 0;
+    gtab->cnt  = 0;
+}
+
+Gtyp *gtab_slot(Gtab *gtab, const Gtyp *gtyp) {
+    assert(gtab);
+    assert(gtyp);
+
+    u64 mask = gtab->cap - 1;
+
+    for (u64 i = gtyp->hash & mask;; i = (i + 1) & mask) {
+        Gtyp *slot = &gtab->data[i];
+
+        if (!slot->count || gtyp_equal(slot, gtyp)) {
+            return slot;
+        }
+    }
+}
+
+void gtab_grow(Gtab *gtab) {
+    assert(gtab);
+
+    Gtab old = *gtab;
+
+    gtab_init(gtab, old.cap * 2);
+
+    for (u64 i = 0; i < old.cap; ++i) {
+        if (old.data[i].count) {
+            *gtab_slot(gtab, &old.data[i]) = old.data[i];
+            gtab->cnt++;
+        }
+    }
+
+    gtab_free(&old);
+}
+
+// Adds all instances of 'gtyp' into the table
+void gtab_add(Gtab *gtab, const Gtyp *gtyp) {
+    assert(gtab);
+    assert(gtyp);
+    assert(gtyp->count);
+
+    // keep load under one half, so probe sequences stay short
+    if ((gtab->cnt + 1) * 2 > gtab->cap) {
+        gtab_grow(gtab);
+    }
+
+    Gtyp *slot = gtab_slot(gtab, gtyp);
+
+    if (slot->count) {
+        slot->count += gtyp->count;
+    } else {
+        *slot = *gtyp;
+        gtab->cnt++;
+    }
+}
+
+int gjob_scan(Gjob *gjob) {
+    assert(gjob);
+
+    const Core *core = gjob->core;
+
+    gtab_init(&gjob->gtab, 1ul << GTAB_INIT_POW);
+
+    for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
+        Gtyp gtyp = {0};
+
+        gtyp.addr  = arch_proc_mb0_addr(core, pix);
+        gtyp.size  = arch_proc_mb0_size(core, pix);
+        gtyp.hash  = mvec_hash(core, gtyp.addr, gtyp.size);
+        gtyp.core  = (u64)(core - g_cores);
+        gtyp.count = 1;
+
+        gtab_add(&gjob->gtab, &gtyp);
+    }
+
+    return 0;
+}
+
+void print_genotype(u64 rank, const Gtyp *gtyp) {
+    assert(gtyp);
+
+    const Core *core = &g_cores[gtyp->core];
+    char        mnem[MNEMONIC_BUFF_SIZE];
+
+    printf(
+        "\n#%lu genotype %#018lx: %#lx instances, %#lx bytes (first on core %lu at %#lx)\n",
+        rank + 1,
+        gtyp->hash,
+        gtyp->count,
+        gtyp->size,
+        gtyp->core,
+        gtyp->addr
+    );
+
+    for (u64 i = 0; i < gtyp->size; ++i) {
+        u8 inst = mvec_get_inst(core, gtyp->addr + i);
+
+        arch_mnemonic(inst, mnem);
+        printf("    0x%04lx  %02x  %s\n", i, inst, mnem);
+    }
+}
+
+int main() {
+    u64 beg = salis_clock_ns();
+
+    salis_load();
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        g_gjobs[i].core = &g_cores[i];
+        thrd_create(&g_gjobs[i].thread, (thrd_start_t)gjob_scan, &g_gjobs[i]);
+    }
+
+    u64 pnum = 0;
+
+    gtab_init(&g_gtab, 1ul << GTAB_INIT_POW);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        thrd_join(g_gjobs[i].thread, NULL);
+
+        for (u64 j = 0; j < g_gjobs[i].gtab.cap; ++j) {
+            if (g_gjobs[i].gtab.data[j].count) {
+                gtab_add(&g_gtab, &g_gjobs[i].gtab.data[j]);
+            }
+        }
+
+        pnum += g_cores[i].pnum;
+        gtab_free(&g_gjobs[i].gtab);
+    }
+
+    // compact occupied slots to the front, then rank them
+    u64 gcnt = 0;
+
+    for (u64 i = 0; i < g_gtab.cap; ++i) {
+        if (g_gtab.data[i].count) {
+            g_gtab.data[gcnt++] = g_gtab.data[i];
+        }
+    }
+
+    assert(gcnt == g_gtab.cnt);
+
+    qsort(g_gtab.data, gcnt, sizeof(Gtyp), gtyp_compare);
+
+    u64 top = GENOME_TOP && GENOME_TOP < gcnt ? GENOME_TOP : gcnt;
+
+    printf("simulation '%s' at step %#lx\n", SIM_NAME, g_steps);
+    printf("%#lx processes, %#lx distinct genotypes, ", pnum, gcnt);
+    printf("scanned in %.3f s\n", (salis_clock_ns() - beg) / 1e9);
+
+    for (u64 i = 0; i < top; ++i) {
+        print_genotype(i, &g_gtab.data[i]);
+    }
+
+    gtab_free(&g_gtab);
+    salis_free();
+
+    return 0;
+}
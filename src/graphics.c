@@ -9,104 +9,145 @@
  * pixel represents a single byte in memory.
  */
 
-u64 g_gfx_vsiz;     // zoom level
-
-u64 *g_gfx_inst;    // instruction channel
-u64 *g_gfx_mall;    // allocated state channel
-u64 *g_gfx_mbst;    // memory block start channel
-u64 *g_gfx_mb0s;    // selected organism's memory block #1 channel
-u64 *g_gfx_mb1s;    // selected organism's memory block #2 channel
-u64 *g_gfx_ipas;    // selected organism's IP channel
-u64 *g_gfx_spas;    // selected organism's SP channel
+typedef struct Gfx Gfx;
+
+// Rendered channels, holding one value per pixel. Each renderer (e.g. a UI,
+// or a background thread) keeps its own, so renders may run concurrently.
+struct Gfx {
+    u64  vsiz;  // number of pixels
+    u64 *inst;  // instruction channel
+    u64 *mall;  // allocated state channel
+    u64 *mbst;  // memory block start channel
+    u64 *mb0s;  // selected organism's memory block #1 channel
+    u64 *mb1s;  // selected organism's memory block #2 channel
+    u64 *ipas;  // selected organism's IP channel
+    u64 *spas;  // selected organism's SP channel
+#if HEAT_MAPS == 1
+    u64 *heat;  // heatmap channel, rendered on demand
+#endif
+};
 
-void gfx_init(u64 vsiz) {
+void gfx_init(Gfx *gfx, u64 vsiz) {
+    assert(gfx);
     assert(vsiz);
 
-    g_gfx_vsiz = vsiz;
-
-    g_gfx_inst = calloc(g_gfx_vsiz, sizeof(u64));
-    g_gfx_mall = calloc(g_gfx_vsiz, sizeof(u64));
-    g_gfx_mbst = calloc(g_gfx_vsiz, sizeof(u64));
-    g_gfx_mb0s = calloc(g_gfx_vsiz, sizeof(u64));
-    g_gfx_mb1s = calloc(g_gfx_vsiz, sizeof(u64));
-    g_gfx_ipas = calloc(g_gfx_vsiz, sizeof(u64));
-    g_gfx_spas = calloc(g_gfx_vsiz, sizeof(u64));
-
-    assert(g_gfx_inst);
-    assert(g_gfx_mall);
-    assert(g_gfx_mbst);
-    assert(g_gfx_mb0s);
-    assert(g_gfx_mb1s);
-    assert(g_gfx_ipas);
-    assert(g_gfx_spas);
+    gfx->vsiz = vsiz;
+
+    gfx->inst = calloc(gfx->vsiz, sizeof(u64));
+    gfx->mall = calloc(gfx->vsiz, sizeof(u64));
+    gfx->mbst = calloc(gfx->vsiz, sizeof(u64));
+    gfx->mb0s = calloc(gfx->vsiz, sizeof(u64));
+    gfx->mb1s = calloc(gfx->vsiz, sizeof(u64));
+    gfx->ipas = calloc(gfx->vsiz, sizeof(u64));
+    gfx->spas = calloc(gfx->vsiz, sizeof(u64));
+#if HEAT_MAPS == 1
+    gfx->heat = calloc(gfx->vsiz, sizeof(u64));
+#endif
+
+    assert(gfx->inst);
+    assert(gfx->mall);
+    assert(gfx->mbst);
+    assert(gfx->mb0s);
+    assert(gfx->mb1s);
+    assert(gfx->ipas);
+    assert(gfx->spas);
+#if HEAT_MAPS == 1
+    assert(gfx->heat);
+#endif
 }
 
-void gfx_free() {
-    if (g_gfx_vsiz == 0) {
+// Bytes allocated across all channels
+u64 gfx_size(const Gfx *gfx) {
+    assert(gfx);
+
+#if HEAT_MAPS == 1
+    return gfx->vsiz * 8 * sizeof(u64);
+#else
+    return gfx->vsiz * 7 * sizeof(u64);
+#endif
+}
+
+void gfx_free(Gfx *gfx) {
+    assert(gfx);
+
+    if (gfx->vsiz == 0) {
         return;
     }
 
-    assert(g_gfx_inst);
-    assert(g_gfx_mall);
-    assert(g_gfx_mbst);
-    assert(g_gfx_mb0s);
-    assert(g_gfx_mb1s);
-    assert(g_gfx_ipas);
-    assert(g_gfx_spas);
-
-    g_gfx_vsiz = 0;
-
-    free(g_gfx_inst);
-    free(g_gfx_mall);
-    free(g_gfx_mbst);
-    free(g_gfx_mb0s);
-    free(g_gfx_mb1s);
-    free(g_gfx_ipas);
-    free(g_gfx_spas);
-
-    g_gfx_inst = NULL;
-    g_gfx_mall = NULL;
-    g_gfx_mbst = NULL;
-    g_gfx_mb0s = NULL;
-    g_gfx_mb1s = NULL;
-    g_gfx_ipas = NULL;
-    g_gfx_spas = NULL;
+    assert(gfx->inst);
+    assert(gfx->mall);
+    assert(gfx->mbst);
+    assert(gfx->mb0s);
+    assert(gfx->mb1s);
+    assert(gfx->ipas);
+    assert(gfx->spas);
+#if HEAT_MAPS == 1
+    assert(gfx->heat);
+#endif
+
+    gfx->vsiz = 0;
+
+    free(gfx->inst);
+    free(gfx->mall);
+    free(gfx->mbst);
+    free(gfx->mb0s);
+    free(gfx->mb1s);
+    free(gfx->ipas);
+    free(gfx->spas);
+#if HEAT_MAPS == 1
+    free(gfx->heat);
+#endif
+
+    gfx->inst = NULL;
+    gfx->mall = NULL;
+    gfx->mbst = NULL;
+    gfx->mb0s = NULL;
+    gfx->mb1s = NULL;
+    gfx->ipas = NULL;
+    gfx->spas = NULL;
+#if HEAT_MAPS == 1
+    gfx->heat = NULL;
+#endif
 }
 
-void gfx_resize(u64 vsiz) {
+void gfx_resize(Gfx *gfx, u64 vsiz) {
+    assert(gfx);
     assert(vsiz);
 
-    gfx_free();
-    gfx_init(vsiz);
+    gfx_free(gfx);
+    gfx_init(gfx, vsiz);
 }
 
-void gfx_render_inst(const Core *core, u64 pos, u64 zoom) {
+void gfx_render_inst(Gfx *gfx, const Core *core, u64 pos, u64 zoom) {
+    assert(gfx);
     assert(core);
 
-    for (u64 i = 0; i < g_gfx_vsiz; ++i) {
-        g_gfx_inst[i] = 0;
-        g_gfx_mall[i] = 0;
+    for (u64 i = 0; i < gfx->vsiz; ++i) {
+        gfx->inst[i] = 0;
+        gfx->mall[i] = 0;
 
         for (u64 j = 0; j < zoom; ++j) {
             u64 addr = pos + (i * zoom) + j;
 
-            g_gfx_inst[i] += mvec_get_byte(core, addr);
-            g_gfx_mall[i] += mvec_is_alloc(core, addr) ? 1 : 0;
+            gfx->inst[i] += mvec_get_byte(core, addr);
+            gfx->mall[i] += mvec_is_alloc(core, addr) ? 1 : 0;
         }
     }
 }
 
-void gfx_clear_array(u64 *arry) {
+void gfx_clear_array(const Gfx *gfx, u64 *arry) {
+    assert(gfx);
     assert(arry);
-    memset(arry, 0, g_gfx_vsiz * sizeof(u64));
+    memset(arry, 0, gfx->vsiz * sizeof(u64));
 }
 
 #ifdef MVEC_LOOP
-void gfx_accumulate_pixel(u64 pos, u64 zoom, u64 pixa, u64 *arry) {
+void gfx_accumulate_pixel(const Gfx *gfx, u64 pos, u64 zoom, u64 pixa, u64 *arry) {
+    assert(gfx);
     assert(arry);
 
     u64 beg_mod = pos % MVEC_SIZE;
-    u64 end_mod = beg_mod + (g_gfx_vsiz * zoom);
+    u64 end_mod = beg_mod + (gfx->vsiz * zoom);
     u64 pix_mod = pixa % MVEC_SIZE;
 
 #ifndef NDEBUG
@@ -116,7 +157,7 @@ void gfx_accumulate_pixel(u64 pos, u64 zoom, u64 pixa, u64 *arry) {
     while (pix_mod < end_mod) {
         if (pix_mod >= beg_mod && pix_mod < end_mod) {
             u64 pixi = (pix_mod - beg_mod) / zoom;
-            assert(pixi < g_gfx_vsiz);
+            assert(pixi < gfx->vsiz);
             arry[pixi]++;
 
 #ifndef NDEBUG
@@ -135,39 +176,42 @@ void gfx_accumulate_pixel(u64 pos, u64 zoom, u64 pixa, u64 *arry) {
 #endif
 }
 #else
-void gfx_accumulate_pixel(u64 pos, u64 zoom, u64 pixa, u64 *arry) {
+void gfx_accumulate_pixel(const Gfx *gfx, u64 pos, u64 zoom, u64 pixa, u64 *arry) {
+    assert(gfx);
     assert(arry);
 
-    u64 end = pos + (g_gfx_vsiz * zoom);
+    u64 end = pos + (gfx->vsiz * zoom);
 
     if (pixa < pos || pixa >= end) {
         return;
     }
 
     u64 pixi = (pixa - pos) / zoom;
-    assert(pixi < g_gfx_vsiz);
+    assert(pixi < gfx->vsiz);
     arry[pixi]++;
 }
 #endif
 
-void gfx_render_mbst(const Core *core, u64 pos, u64 zoom) {
+void gfx_render_mbst(Gfx *gfx, const Core *core, u64 pos, u64 zoom) {
+    assert(gfx);
     assert(core);
 
-    gfx_clear_array(g_gfx_mbst);
+    gfx_clear_array(gfx, gfx->mbst);
 
     for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
         u64 mb0a = arch_proc_mb0_addr(core, pix);
         u64 mb1a = arch_proc_mb1_addr(core, pix);
 
-        gfx_accumulate_pixel(pos, zoom, mb0a, g_gfx_mbst);
-        gfx_accumulate_pixel(pos, zoom, mb1a, g_gfx_mbst);
+        gfx_accumulate_pixel(gfx, pos, zoom, mb0a, gfx->mbst);
+        gfx_accumulate_pixel(gfx, pos, zoom, mb1a, gfx->mbst);
     }
 }
 
-void gfx_render_mb0s(const Core *core, u64 pos, u64 zoom, u64 psel) {
+void gfx_render_mb0s(Gfx *gfx, const Core *core, u64 pos, u64 zoom, u64 psel) {
+    assert(gfx);
     assert(core);
 
-    gfx_clear_array(g_gfx_mb0s);
+    gfx_clear_array(gfx, gfx->mb0s);
 
     if (psel < core->pfst || psel > core->plst) {
         return;
@@ -177,14 +221,15 @@ void gfx_render_mb0s(const Core *core, u64 pos, u64 zoom, u64 psel) {
     u64 mb0s = arch_proc_mb0_size(core, psel);
 
     for (u64 i = 0; i < mb0s; ++i) {
-        gfx_accumulate_pixel(pos, zoom, mb0a + i, g_gfx_mb0s);
+        gfx_accumulate_pixel(gfx, pos, zoom, mb0a + i, gfx->mb0s);
     }
 }
 
-void gfx_render_mb1s(const Core *core, u64 pos, u64 zoom, u64 psel) {
+void gfx_render_mb1s(Gfx *gfx, const Core *core, u64 pos, u64 zoom, u64 psel) {
+    assert(gfx);
     assert(core);
 
-    gfx_clear_array(g_gfx_mb1s);
+    gfx_clear_array(gfx, gfx->mb1s);
 
     if (psel < core->pfst || psel > core->plst) {
         return;
@@ -194,14 +239,15 @@ void gfx_render_mb1s(const Core *core, u64 pos, u64 zoom, u64 psel) {
     u64 mb1s = arch_proc_mb1_size(core, psel);
 
     for (u64 i = 0; i < mb1s; ++i) {
-        gfx_accumulate_pixel(pos, zoom, mb1a + i, g_gfx_mb1s);
+        gfx_accumulate_pixel(gfx, pos, zoom, mb1a + i, gfx->mb1s);
     }
 }
 
-void gfx_render_ipas(const Core *core, u64 pos, u64 zoom, u64 psel) {
+void gfx_render_ipas(Gfx *gfx, const Core *core, u64 pos, u64 zoom, u64 psel) {
+    assert(gfx);
     assert(core);
 
-    gfx_clear_array(g_gfx_ipas);
+    gfx_clear_array(gfx, gfx->ipas);
 
     if (psel < core->pfst || psel > core->plst) {
         return;
@@ -209,13 +255,14 @@ void gfx_render_ipas(const Core *core, u64 pos, u64 zoom, u64 psel) {
 
     u64 ipa = arch_proc_ip_addr(core, psel);
 
-    gfx_accumulate_pixel(pos, zoom, ipa, g_gfx_ipas);
+    gfx_accumulate_pixel(gfx, pos, zoom, ipa, gfx->ipas);
 }
 
-void gfx_render_spas(const Core *core, u64 pos, u64 zoom, u64 psel) {
+void gfx_render_spas(Gfx *gfx, const Core *core, u64 pos, u64 zoom, u64 psel) {
+    assert(gfx);
     assert(core);
 
-    gfx_clear_array(g_gfx_spas);
+    gfx_clear_array(gfx, gfx->spas);
 
     if (psel < core->pfst || psel > core->plst) {
         return;
@@ -223,16 +270,44 @@ void gfx_render_spas(const Core *core, u64 pos, u64 zoom, u64 psel) {
 
     u64 spa = arch_proc_sp_addr(core, psel);
 
-    gfx_accumulate_pixel(pos, zoom, spa, g_gfx_spas);
+    gfx_accumulate_pixel(gfx, pos, zoom, spa, gfx->spas);
+}
+
+#if HEAT_MAPS == 1
+// Sums, for every byte a pixel covers, the count of the heatmap bucket
+// holding it. Values are thus proportional (by the bucket size) to events
+// within each pixel, even when buckets span several pixels.
+void gfx_render_heat(Gfx *gfx, const Core *core, u64 pos, u64 zoom, int kind) {
+    assert(gfx);
+    assert(core);
+    assert(kind < HEAT_COUNT);
+
+    for (u64 i = 0; i < gfx->vsiz; ++i) {
+        gfx->heat[i] = 0;
+
+        for (u64 j = 0; j < zoom; ++j) {
+            u64 addr = pos + (i * zoom) + j;
+
+#ifndef MVEC_LOOP
+            if (addr >= MVEC_SIZE) {
+                break;
+            }
+#endif
+
+            gfx->heat[i] += core->heat[kind][mvec_index(addr) >> HEAT_BUCKET_POW];
+        }
+    }
 }
+#endif
 
-void gfx_render(const Core *core, u64 pos, u64 zoom, u64 psel) {
+void gfx_render(Gfx *gfx, const Core *core, u64 pos, u64 zoom, u64 psel) {
+    assert(gfx);
     assert(core);
 
-    gfx_render_inst(core, pos, zoom);
-    gfx_render_mbst(core, pos, zoom);
-    gfx_render_mb0s(core, pos, zoom, psel);
-    gfx_render_mb1s(core, pos, zoom, psel);
-    gfx_render_ipas(core, pos, zoom, psel);
-    gfx_render_spas(core, pos, zoom, psel);
+    gfx_render_inst(gfx, core, pos, zoom);
+    gfx_render_mbst(gfx, core, pos, zoom);
+    gfx_render_mb0s(gfx, core, pos, zoom, psel);
+    gfx_render_mb1s(gfx, core, pos, zoom, psel);
+    gfx_render_ipas(gfx, core, pos, zoom, psel);
+    gfx_render_spas(gfx, core, pos, zoom, psel);
 }
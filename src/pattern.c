@@ -0,0 +1,304 @@
+// Project: Salis
+// Author:  Paul Oliver
+// Email:   contact@pauloliver.dev
+
+/*
+ * This module searches memory vectors for instruction patterns. Patterns are
+ * lists of tokens, separated by spaces or commas, each one being either a
+ * mnemonic (matching all instructions sharing it), a hex instruction value
+ * or a '?' wildcard. Each core gets scanned on its own thread. Scans look for
+ * a single anchor position of the pattern, the one accepting the fewest
+ * instructions, eight bytes at a time (SWAR, so builds stay portable), and
+ * only candidates found this way get compared against the whole pattern.
+ * Matches are reported along with the process owning them, if any.
+ */
+
+#define PTRN_MAX_SIZE (0x40)
+#define PTRN_MAX_ANCR (0x8)         // instructions an anchor may accept
+#define PTRN_NONE     ((u64)-1)     // owner of matches found in free memory
+#define PTRN_LANE     (0x0101010101010101ul)
+#define PTRN_LOW7     (0x7f7f7f7f7f7f7f7ful)
+#define PTRN_HIGH     (0x8080808080808080ul)
+
+typedef struct Pjob Pjob;
+typedef struct Pmat Pmat;
+typedef struct Ptrn Ptrn;
+
+struct Ptrn {
+    u64 accp[PTRN_MAX_SIZE][2];     // instructions accepted at each position
+    u64 size;
+    u64 ancr;                       // position scanned for
+    u8  anci[PTRN_MAX_ANCR];        // instructions accepted by the anchor
+    u64 ancn;                       // zero if no position makes a good anchor
+};
+
+struct Pmat {
+    u64 addr;
+    u64 ownr;
+};
+
+// Searches a single core, keeping up to 'limt' matches (all if zero)
+struct Pjob {
+    const Ptrn *ptrn;
+    const Core *core;
+    Thread      thread;
+    u64         limt;
+    Pmat       *mats;
+    u64         mnum;
+    u64         mcap;
+    u64         totl;   // matches found, including those not kept
+};
+
+bool ptrn_accepts(const Ptrn *ptrn, u64 pos, u8 inst) {
+    assert(ptrn);
+    assert(pos < ptrn->size);
+    assert(inst < INST_CAPS);
+
+    return (ptrn->accp[pos][inst >> 6] >> (inst & 0x3f)) & 1;
+}
+
+// Parses 'text' into 'ptrn'. Returns false if any token is unknown, or if
+// the pattern is empty or too long.
+bool ptrn_parse(Ptrn *ptrn, const char *text) {
+    assert(ptrn);
+    assert(text);
+
+    char  buff[0x400];
+    char *save = NULL;
+
+    memset(ptrn, 0, sizeof(Ptrn));
+
+    if (strlen(text) >= sizeof(buff)) {
+        return false;
+    }
+
+    strcpy(buff, text);
+
+    for (char *tokn = strtok_r(buff, " ,", &save); tokn; tokn = strtok_r(NULL, " ,", &save)) {
+        if (ptrn->size == PTRN_MAX_SIZE) {
+            return false;
+        }
+
+        u64 *accp = ptrn->accp[ptrn->size++];
+
+        if (!strcmp(tokn, "?")) {
+            accp[0] = accp[1] = (u64)-1;
+            continue;
+        }
+
+        char mnem[MNEMONIC_BUFF_SIZE];
+
+        for (int i = 0; i < INST_CAPS; ++i) {
+            arch_mnemonic((u8)i, mnem);
+
+            if (!strcmp(tokn, mnem)) {
+                accp[i >> 6] |= 1ul << (i & 0x3f);
+            }
+        }
+
+        if (accp[0] || accp[1]) {
+            continue;
+        }
+
+        char *end  = NULL;
+        u64   inst = strtoull(tokn, &end, 16);
+
+        if (*end || end == tokn || inst >= INST_CAPS) {
+            return false;
+        }
+
+        accp[inst >> 6] |= 1ul << (inst & 0x3f);
+    }
+
+    if (!ptrn->size) {
+        return false;
+    }
+
+    // anchor on the most selective position, so candidates are rare
+    u64 best = INST_CAPS + 1;
+
+    for (u64 i = 0; i < ptrn->size; ++i) {
+        u64 cnt = __builtin_popcountl(ptrn->accp[i][0]) + __builtin_popcountl(ptrn->accp[i][1]);
+
+        if (cnt < best) {
+            best       = cnt;
+            ptrn->ancr = i;
+        }
+    }
+
+    if (best <= PTRN_MAX_ANCR) {
+        for (int i = 0; i < INST_CAPS; ++i) {
+            if (ptrn_accepts(ptrn, ptrn->ancr, (u8)i)) {
+                ptrn->anci[ptrn->ancn++] = (u8)i;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ptrn_match(const Ptrn *ptrn, const Core *core, u64 addr) {
+    assert(ptrn);
+    assert(core);
+
+#ifndef MVEC_LOOP
+    if (addr + ptrn->size > MVEC_SIZE) {
+        return false;
+    }
+#endif
+
+    for (u64 i = 0; i < ptrn->size; ++i) {
+        if (!ptrn_accepts(ptrn, i, mvec_get_inst(core, addr + i))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void pjob_push(Pjob *pjob, u64 addr) {
+    assert(pjob);
+
+    pjob->totl++;
+
+    if (pjob->limt && pjob->mnum == pjob->limt) {
+        return;
+    }
+
+    if (pjob->mnum == pjob->mcap) {
+        pjob->mcap = pjob->mcap ? pjob->mcap * 2 : 0x40;
+        pjob->mats = realloc(pjob->mats, pjob->mcap * sizeof(Pmat));
+
+        assert(pjob->mats);
+    }
+
+    pjob->mats[pjob->mnum++].addr = addr;
+}
+
+// Checks the candidate match whose anchor lies at 'pos'
+void pjob_check(Pjob *pjob, u64 pos) {
+    assert(pjob);
+
+    const Ptrn *ptrn = pjob->ptrn;
+
+    if (pos < ptrn->ancr) {
+#ifdef MVEC_LOOP
+        pos += MVEC_SIZE;
+#else
+        return;
+#endif
+    }
+
+    u64 addr = pos - ptrn->ancr;
+
+    if (ptrn_match(ptrn, pjob->core, addr)) {
+        pjob_push(pjob, addr);
+    }
+}
+
+// Scans anchor positions within [beg, end). Instructions are compared a
+// word at a time, with allocation flags masked off, and bytes holding an
+// accepted instruction (those whose difference is zero) get flagged in their
+// high bits. Differences never exceed 0x7f, so no carries cross lanes.
+void pjob_scan(Pjob *pjob, u64 beg, u64 end) {
+    assert(pjob);
+    assert(beg <= end && end <= MVEC_SIZE);
+
+    const Ptrn *ptrn = pjob->ptrn;
+    const u8   *mvec = pjob->core->mvec;
+    u64         pos  = beg;
+
+    if (!ptrn->ancn) {
+        for (; pos < end; ++pos) {
+            pjob_check(pjob, pos);
+        }
+
+        return;
+    }
+
+    u64 lane[PTRN_MAX_ANCR];
+
+    for (u64 i = 0; i < ptrn->ancn; ++i) {
+        lane[i] = PTRN_LANE * ptrn->anci[i];
+    }
+
+    for (; pos + sizeof(u64) <= end; pos += sizeof(u64)) {
+        u64 word = 0;
+        u64 hits = 0;
+
+        memcpy(&word, &mvec[pos], sizeof(u64));
+
+        word &= PTRN_LOW7;
+
+        for (u64 i = 0; i < ptrn->ancn; ++i) {
+            hits |= ~((word ^ lane[i]) + PTRN_LOW7) & PTRN_HIGH;
+        }
+
+        // lowest addressed bytes sit in the lowest bits on little endian hosts
+        while (hits) {
+            pjob_check(pjob, pos + __builtin_ctzl(hits) / 8);
+            hits &= hits - 1;
+        }
+    }
+
+    for (; pos < end; ++pos) {
+        u8 inst = mvec[pos] & INST_MASK;
+
+        if (ptrn_accepts(ptrn, ptrn->ancr, inst)) {
+            pjob_check(pjob, pos);
+        }
+    }
+}
+
+int pjob_run(Pjob *pjob) {
+    assert(pjob);
+
+    const Core *core = pjob->core;
+    u64         ancr = pjob->ptrn->ancr < MVEC_SIZE ? pjob->ptrn->ancr : MVEC_SIZE;
+
+    // matches get listed by address, so those wrapping around come last
+    pjob_scan(pjob, ancr, MVEC_SIZE);
+    pjob_scan(pjob, 0, ancr);
+
+    for (u64 i = 0; i < pjob->mnum; ++i) {
+        Pmat *pmat = &pjob->mats[i];
+
+        pmat->ownr = mvec_is_alloc(core, pmat->addr) ? mvec_get_owner(core, pmat->addr) : PTRN_NONE;
+    }
+
+    return 0;
+}
+
+void pjob_free(Pjob *pjob) {
+    assert(pjob);
+
+    free(pjob->mats);
+
+    pjob->mats = NULL;
+    pjob->mnum = 0;
+    pjob->mcap = 0;
+    pjob->totl = 0;
+}
+
+// Searches all cores in parallel, each one into its own job
+void ptrn_search(const Ptrn *ptrn, const Core *cores, Pjob *pjobs, u64 limt) {
+    assert(ptrn);
+    assert(cores);
+    assert(pjobs);
+
+    _Static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "pattern scans assume little endian hosts");
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        pjob_free(&pjobs[i]);
+
+        pjobs[i].ptrn = ptrn;
+        pjobs[i].core = &cores[i];
+        pjobs[i].limt = limt;
+
+        thrd_create(&pjobs[i].thread, (thrd_start_t)pjob_run, &pjobs[i]);
+    }
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        thrd_join(pjobs[i].thread, NULL);
+    }
+}
@@ -7,14 +7,29 @@
  * and UI modules.
  */
 
+#define _DEFAULT_SOURCE
+
 #include <assert.h>
 #include <ctype.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <threads.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#if PERF_EVENTS == 1
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
 
 #define ACT_BENCH (1)
 #define ACT_LOAD  (2)
@@ -22,6 +37,56 @@
 
 #define ASM_LINE_LEN (0x100)
 
+#define SAVE_BUFF_ALGN (0x1000)
+#define SAVE_BUFF_SIZE (0x400000)
+#define SAVE_TEMP_EXTN ".tmp"
+#define SAVE_DELT_EXTN ".delta"
+#define SAVE_SECT_ALGN (0x1000)
+#define SAVE_MAGIC     "SALISSAV"
+#define SAVE_VERSION   (2)
+#define SAVE_NAME_LEN  (0x20)
+#define SAVE_FELD_LEN  (0x10)
+#define SAVE_KIND_FULL (0)
+#define SAVE_KIND_PACK (1)
+#define SAVE_KIND_DELT (2)
+
+#define MVEC_PAGE_POW  (12)
+#define MVEC_PAGE_SIZE (1ul << MVEC_PAGE_POW)
+#define MVEC_PAGE_CNT  ((MVEC_SIZE + MVEC_PAGE_SIZE - 1) >> MVEC_PAGE_POW)
+
+#define CORE_STATE_SIZE (13 * sizeof(u64))
+
+#define STRM_RING_POW  (16)
+#define STRM_RING_SIZE (1ul << STRM_RING_POW)
+#define STRM_RING_MASK (STRM_RING_SIZE - 1)
+#define STRM_IDLE_NS   (1000000)
+
+#define EVNT_MAGIC   "SALISEVT"
+#define EVNT_VERSION (1)
+
+#define PHYL_MAGIC   "SALISPHY"
+#define PHYL_VERSION (1)
+#define PHYL_EXTN    ".phylo"
+#define PHYL_NONE    ((u64)-1)
+
+#define STAT_MAGIC    "SALISTAT"
+#define STAT_VERSION  (1)
+#define STAT_EXTN     ".stats"
+#define STAT_NAME_LEN (sizeof(SIM_PATH STAT_EXTN) + 0x10)
+#define STAT_HEAD_LEN (0x20)
+#define STAT_ROWS     SIM_PATH STAT_EXTN "/rows"
+
+#define PHASE_HIST_LEN (64)
+
+#define CENS_TOP      (0x10)
+#define CENS_INIT_CAP (0x100)
+
+#define HEAT_MAGIC   "SALISHEA"
+#define HEAT_VERSION (1)
+#define HEAT_EXTN    ".heat"
+
+#define SBAR_HIST_LEN (64)
+
 #define MALL_FLAG (0x80)
 #define IPCM_FLAG (0x80)
 #define INST_CAPS (0x80)
@@ -29,13 +94,185 @@
 
 #define U64_HALF (0x8000000000000000)
 
+typedef struct Cens Cens;
+typedef struct Cgen Cgen;
+typedef struct Ckpt Ckpt;
 typedef struct Core Core;
+typedef struct Evnt Evnt;
+typedef struct Head Head;
+typedef struct Hfld Hfld;
+typedef struct Hsec Hsec;
+typedef struct Iost Iost;
 typedef struct Ipcm Ipcm;
+typedef struct Pack Pack;
+typedef struct Phtm Phtm;
+typedef struct Phyl Phyl;
 typedef struct Proc Proc;
+typedef struct Ring Ring;
+typedef struct Sbar Sbar;
+typedef struct Strm Strm;
 typedef thrd_t      Thread;
 typedef uint64_t    u64;
 typedef uint8_t     u8;
 
+#if PHASE_TIMING == 1
+/*
+ * Phases timed on each core's thread and on the main thread. Each phase is
+ * listed along with the call stack it gets exported under, in the folded
+ * format read by flamegraph tools. Stepping time is whatever core threads
+ * spend outside of the other core phases, and thread time is whatever the
+ * main thread spends creating and joining core threads, beyond the slowest
+ * core's work.
+ */
+#define PHASE_CORE_LIST                                    \
+    PHASE(step, "salis_thread;core_step;arch_proc_step")   \
+    PHASE(reap, "salis_thread;core_step;proc_kill")        \
+    PHASE(cray, "salis_thread;core_step;muta_cosmic_ray")
+
+#define PHASE_MAIN_LIST                                    \
+    PHASE(thrd, "salis_step;salis_run_thread")             \
+    PHASE(sync, "salis_step;salis_sync")                   \
+    PHASE(asav, "salis_step;salis_auto_save")              \
+    PHASE(uirn, "ui_render")
+
+enum {
+#define PHASE(name, stck) PHSC_##name,
+    PHASE_CORE_LIST
+#undef PHASE
+    PHSC_COUNT
+};
+
+enum {
+#define PHASE(name, stck) PHSM_##name,
+    PHASE_MAIN_LIST
+#undef PHASE
+    PHSM_COUNT
+};
+
+// Phase timer, counting cycles as read from the time stamp counter, with a
+// histogram of occurrence lengths in power of two buckets
+struct Phtm {
+    u64 cnt;
+    u64 cycs;
+    u64 hist[PHASE_HIST_LEN];
+};
+#endif
+
+#if PERF_EVENTS == 1
+/*
+ * Events counted on every core thread, along with their perf type and
+ * config. Task clock is a software event, so it stays available (and keeps
+ * per-core rates meaningful) on machines or VMs lacking a hardware PMU.
+ */
+#define PERF_CACHE_MISS(cache) \
+    (PERF_COUNT_HW_CACHE_##cache | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+
+#define PERF_EVENT_LIST                                                           \
+    PERF_EVENT(tclk, "task ns",       PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK)  \
+    PERF_EVENT(cycs, "cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES)  \
+    PERF_EVENT(inst, "instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS) \
+    PERF_EVENT(l1dm, "L1d misses",    PERF_TYPE_HW_CACHE, PERF_CACHE_MISS(L1D))      \
+    PERF_EVENT(llcm, "LLC misses",    PERF_TYPE_HW_CACHE, PERF_CACHE_MISS(LL))       \
+    PERF_EVENT(dtlb, "dTLB misses",   PERF_TYPE_HW_CACHE, PERF_CACHE_MISS(DTLB))     \
+    PERF_EVENT(brms, "branch misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES)
+
+enum {
+#define PERF_EVENT(name, desc, type, conf) PRFC_##name,
+    PERF_EVENT_LIST
+#undef PERF_EVENT
+    PRFC_COUNT
+};
+#endif
+
+#if HEAT_MAPS == 1
+#define HEAT_BUCKET_SIZE (1ul << HEAT_BUCKET_POW)
+#define HEAT_BUCKET_CNT  ((MVEC_SIZE + HEAT_BUCKET_SIZE - 1) >> HEAT_BUCKET_POW)
+
+// Events counted into heatmaps, each one into its own map
+enum {
+    HEAT_EXEC,  // instruction fetches, sampled
+    HEAT_WRTE,  // writes by processes and IPC pulls, sampled
+    HEAT_CRAY,  // cosmic ray hits, all of them
+    HEAT_COUNT
+};
+#endif
+
+// Subsystems accounted for in memory footprints
+enum {
+    MEMS_CORE,  // core struct, holding the memory vector and thread gap
+    MEMS_PVEC,  // process vector
+#if PHYLO_LOG == 1
+    MEMS_PBST,  // process birth steps
+#endif
+#if GENOME_CENSUS == 1
+    MEMS_CENS,  // genotype census, along with process genotypes
+#endif
+    MEMS_IPCM,  // IPC buffers
+    MEMS_COUNT
+};
+
+#if OPCODE_STATS == 1
+// Instruction outcomes, counted next to opcodes by architectures having them
+enum {
+    OPEV_SEEK,  // seeks given up for lack of a key to match
+    OPEV_ALLC,  // allocation steps colliding with allocated memory
+    OPEV_WRTE,  // writes blocked by memory ownership
+    OPEV_COUNT
+};
+#endif
+
+// Sync barrier accounting, in nanoseconds. Every sync interval, each core
+// computes on its own thread, then waits for the slowest one to finish.
+struct Sbar {
+    u64 tbeg;   // last thread run start, as set by the core's thread
+    u64 tend;   // last thread run end, as set by the core's thread
+    u64 cmpl;   // compute time of the last run
+    u64 watl;   // wait time of the last run, behind the straggler
+    u64 cmpt;   // total compute time
+    u64 watt;   // total wait time
+    u64 strg;   // runs at which this core was the straggler
+    u64 hist[SBAR_HIST_LEN];   // wait times, in power of two buckets
+};
+
+#if GENOME_CENSUS == 1
+// A genotype in a core's census, with its genome interned in the arena.
+// Extinct genotypes linger, with no count, until the census gets compacted.
+struct Cgen {
+    u64 hash;
+    u64 size;
+    u64 offs;   // genome bytes, within the arena
+    u64 cnt;    // live processes carrying this genotype
+    u64 rank;   // position within the rank array
+};
+
+/*
+ * Genotype census of a core, updated at every birth and death. Genotypes
+ * are stored densely, so processes may refer to them by index, and found
+ * through an open addressing table. The rank array keeps them sorted by
+ * descending count: counts only ever change by one, so a genotype only needs
+ * swapping with the first (or last) one sharing its count, whose position is
+ * tracked in 'frst'. The sum of squared counts is kept as well, so richness,
+ * top genotypes and Simpson's index are all read without scanning.
+ */
+struct Cens {
+    Cgen *gvec;
+    u64   gnum;
+    u64   gcap;
+    u64  *htab;     // genotype indices plus one, zero when empty
+    u64   hcap;
+    u64  *rank;
+    u64  *frst;     // number of genotypes counted above each count
+    u64   fcap;
+    u8   *arna;
+    u64   asiz;
+    u64   acap;
+    u8   *gbuf;     // scratch buffer, genomes get copied here to be hashed
+    u64   gbsz;
+    u64   pnum;     // processes counted
+    u64   sqrs;     // sum of squared counts
+};
+#endif
+
 struct Core {
     u64    mall;
     u64    muta[4];
@@ -49,564 +286,3831 @@ struct Core {
 
     Thread thread;
     u64    tix;
+    Sbar   sbar;
 
     u64    ivpt;
     u8    *iviv;
     u64   *ivav;
 
+#if STATE_DIGEST == 1
+    u64    mvhs;
+    u64    ivhs;
+#endif
+
+#if DELTA_BASE > 1
+    u8     mdrt[MVEC_PAGE_CNT];
+#endif
+
     Proc  *pvec;
-    u8     mvec[MVEC_SIZE];
+    u64    pnpk;    // peak process count, this session
+    u64    pcpk;    // peak process vector capacity, this session
+    u64    pgrw;    // process vector growths, this session
+
+#if PHYLO_LOG == 1
+    u64   *pbst;    // birth steps, laid out in parallel with 'pvec'
+#endif
+
+#if GENOME_CENSUS == 1
+    Cens   cens;
+    u64   *pgid;    // census genotypes, laid out in parallel with 'pvec'
+#endif
+
+#if STATS_LOG == 1
+    u64    stps;    // IPC messages pushed since last sync
+    u64    stpl;    // IPC messages pulled since last sync
+    u64    stns;    // nanoseconds spent stepping since last sync
+#endif
+
+#if PHASE_TIMING == 1
+    Phtm   phtm[PHSC_COUNT];    // only ever touched by the core's own thread
+    u64    phtb;                // cycles busy during the last thread run
+#endif
+
+#if PERF_EVENTS == 1
+    u64    prfc[PRFC_COUNT];    // event totals, scaled up when multiplexed
+    u64    prfu;                // bitmask of events that could not be opened
+#endif
+
+#if HEAT_MAPS == 1
+    u64    htcd[HEAT_COUNT];    // events seen since last sample, per map
+    u64    heat[HEAT_COUNT][HEAT_BUCKET_CNT];
+#endif
+
+#if OPCODE_STATS == 1
+    u64    opci[INST_CAPS];     // instructions executed by opcode, since last merge
+    u64    opce[OPEV_COUNT];    // instruction outcomes, since last merge
+#endif
+
+    // aligned so that loads may map saved memory directly into place
+    _Alignas(SAVE_SECT_ALGN) u8 mvec[MVEC_SIZE];
     u8     tgap[TGAP_SIZE];
 };
 
+// Save and load statistics
+struct Iost {
+    u64 rsiz;   // raw (uncompressed, full snapshot equivalent) bytes
+    u64 psiz;   // bytes actually written or read
+    u64 time;   // wall time in nanoseconds
+    u64 count;  // number of completed saves or loaded files
+};
+
+// Per-core save or load job, run on its own thread
+struct Pack {
+    Core  *core;
+    Thread thread;
+    bool   cmpr;
+    u8    *data;
+    u64    size;
+    u64    csum;
+};
+
+/*
+ * Every save file starts with a header describing its contents, so that it
+ * can be validated on load and read by external tools. The fixed part is
+ * followed by a table describing the layout of the architecture's process
+ * struct (one entry per PROC_FIELDS entry) and by a table locating each
+ * core's section within the file. All integers are stored in native (little
+ * endian) byte order.
+ */
+struct Head {
+    char magc[8];               // SAVE_MAGIC, not null terminated
+    u64  vers;                  // SAVE_VERSION
+    u64  kind;                  // full, compressed or delta (SAVE_KIND_*)
+    char arch[SAVE_NAME_LEN];   // architecture name
+    u64  ccnt;                  // core count
+    u64  mvsz;                  // memory vector size
+    u64  sync;                  // sync interval
+    u64  psiz;                  // size of process struct
+    u64  pfnm;                  // number of process fields
+    u64  step;                  // simulation step
+    u64  sncs;                  // number of syncs
+    u64  prnt;                  // step of parent checkpoint (deltas only)
+    u64  hsiz;                  // size of header, including its tables
+};
+
+struct Hfld {
+    char name[SAVE_FELD_LEN];
+    u64  offs;
+    u64  size;
+};
+
+struct Hsec {
+    u64 offs;   // offset of core section from start of file
+    u64 size;   // size of core section
+    u64 csum;   // checksum of core state after loading this file
+};
+
+/*
+ * Event log records. Steps are global simulation steps; records coming from
+ * the same source (a core, or the main thread) appear in the log in order,
+ * while sources are interleaved arbitrarily.
+ */
+enum {
+    EVNT_OPEN,  // simulation opened (or created) at 'step'
+    EVNT_MUTA,  // cosmic ray at 'addr', turning byte 'prev' into 'inst'
+    EVNT_PUSH,  // IPC message 'inst' to 'addr' pushed into slot 'slot'
+    EVNT_PULL,  // IPC message 'inst' to 'addr' pulled from slot 'slot'
+    EVNT_SYNC,  // cores synced, 'addr' holds the new sync count
+    EVNT_RWND,  // simulation rewound to 'step', earlier records past it are void
+};
+
+struct Evnt {
+    u64      step;
+    u64      addr;
+    uint32_t slot;
+    u8       kind;
+    u8       core;
+    u8       inst;
+    u8       prev;
+};
+
+/*
+ * Phylogeny log records. Births come from splits and carry the parent's
+ * index along with a hash of the child's genome (its first memory block);
+ * deaths carry the age of the process in steps. Processes alive before the
+ * log was (re)opened have unknown birth steps, so their deaths only give a
+ * lower bound of their age, flagged with PHYL_FLAG_AGLB. Open records
+ * written on rewinds void any earlier records past their step.
+ */
+enum {
+    PHYL_OPEN,  // log opened (or simulation rewound) at 'step', once per core
+    PHYL_BORN,  // process 'pix' split from 'prnt' (PHYL_NONE for ancestors)
+    PHYL_DEAD,  // process 'pix' killed at 'age' steps old
+};
+
+#define PHYL_FLAG_AGLB (0x01)
+
+struct Phyl {
+    u64 step;
+    u64 pix;
+    u64 prnt;
+    u64 addr;   // memory block 0 address
+    u64 size;   // memory block 0 size
+    u64 hash;   // genome hash (births only)
+    u64 age;    // age in steps (deaths only)
+    u8  kind;
+    u8  core;
+    u8  flag;
+    u8  rsvd[5];
+};
+
+// Single producer, single consumer record ring
+struct Ring {
+    _Atomic u64              head;
+    _Alignas(64) _Atomic u64 tail;
+    _Alignas(64) u8         *data;
+};
+
+/*
+ * Binary record stream. Each core pushes records into its own ring, with the
+ * main thread using an extra one. Rings get drained into the stream's file by
+ * a background thread, so cores never take locks; they only wait when their
+ * ring is full. Records coming from the same ring appear in the file in
+ * order, while rings are interleaved arbitrarily.
+ */
+struct Strm {
+    FILE      *file;
+    Thread     thread;
+    atomic_int stop;
+    u64        rsiz;
+    Ring       ring[CORE_COUNT + 1];
+};
+
+/*
+ * Statistics columns, sampled at every sync. Each column gets stored in its
+ * own file, made of a small header (magic, version, values per row and sync
+ * interval) followed by fixed-width rows of u64 values: one value per row on
+ * global columns, one per core on core columns. 'pend' and 'pfst' are the
+ * ends of each core's process ring, so they are cumulative over the
+ * simulation's lifetime: processes ever created (initial ancestors included)
+ * and ever reaped. Per-sync births and deaths are differences of consecutive
+ * rows. IPC and timing columns count over the last sync interval only.
+ */
+#define STAT_GLOBAL_COLUMNS     \
+    STAT_COLUMN(step, g_steps)  \
+    STAT_COLUMN(time, salis_real_ns())
+
+#define STAT_CORE_COLUMNS                \
+    STAT_COLUMN(pnum, core->pnum)        \
+    STAT_COLUMN(mall, core->mall)        \
+    STAT_COLUMN(ncyc, core->ncyc)        \
+    STAT_COLUMN(pend, core->plst + 1)    \
+    STAT_COLUMN(pfst, core->pfst)        \
+    STAT_COLUMN(ipsh, core->stps)        \
+    STAT_COLUMN(ipul, core->stpl)        \
+    STAT_COLUMN(nsec, core->stns)
+
+enum {
+#define STAT_COLUMN(name, expr) STAT_COL_##name,
+    STAT_GLOBAL_COLUMNS
+    STAT_CORE_COLUMNS
+#undef STAT_COLUMN
+    STAT_COL_COUNT,
+};
+
+enum {
+#define STAT_COLUMN(name, expr) STAT_GLB_##name,
+    STAT_GLOBAL_COLUMNS
+#undef STAT_COLUMN
+    STAT_GLOBAL_COUNT,
+};
+
+// In-memory rewind checkpoint, with each core serialized separately
+struct Ckpt {
+    u64  step;
+    u64  sncs;
+    Pack pack[CORE_COUNT];
+};
+
 Core       g_cores[CORE_COUNT];
 u64        g_steps;
 u64        g_syncs;
+u64        g_sbar_runs;
+u64        g_sbar_wall;
 #if ACTION == ACT_LOAD || ACTION == ACT_NEW
 char       g_asav_pbuf[AUTO_SAVE_NAME_LEN];
+char       g_asav_path[AUTO_SAVE_NAME_LEN];   // save being written
+pid_t      g_asav_pid;
+u64        g_asav_count;
+u64        g_asav_block;
+u64        g_asav_block_total;
+Iost      *g_iost_save;
+#endif
+#if ACTION == ACT_LOAD
+Iost       g_iost_load;
+u64        g_load_csum[CORE_COUNT];
+#endif
+#if DELTA_BASE > 1
+bool       g_delt_live;
+u64        g_delt_prnt;
+#endif
+#if STATE_DIGEST == 1
+FILE      *g_dgst_file;
+#endif
+#if EVENT_LOG == 1
+Strm       g_evnt_strm;
+#endif
+#if PHYLO_LOG == 1
+Strm       g_phyl_strm;
+u64        g_phyl_base;
+#endif
+#if STATS_LOG == 1
+FILE      *g_stat_files[STAT_COL_COUNT];
+FILE      *g_stat_rows;
+u64        g_stat_nrow;
+#endif
+#if PHASE_TIMING == 1
+Phtm       g_phtm[PHSM_COUNT];
+u64        g_phase_tsc0;
+u64        g_phase_ns0;
+#endif
+#if OPCODE_STATS == 1
+u64        g_opcs_inst[CORE_COUNT][INST_CAPS];
+u64        g_opcs_evnt[CORE_COUNT][OPEV_COUNT];
+#endif
+#if REWIND_RING > 0
+Ckpt       g_ckpt_ring[REWIND_RING];
+u64        g_ckpt_next;
+bool       g_rply;   // replaying forward from a restored checkpoint
 #endif
 const Proc g_dead_proc;
 
 #include ARCH_SOURCE
 
-#if ACTION == ACT_BENCH || ACTION == ACT_NEW
-char g_mnemo_table[0x100][MNEMONIC_BUFF_SIZE];
+#if SAVE_COMPRESS == 1 || ACTION == ACT_LOAD || REWIND_RING > 0
+#include "codec.c"
 #endif
 
-#ifdef MVEC_LOOP
-u64 mvec_loop(u64 addr) {
-    return addr % MVEC_SIZE;
-}
+#if ACTION == ACT_LOAD || ACTION == ACT_NEW
+const Hfld g_save_flds[] = {
+#define PROC_FIELD(type, name) { #name, offsetof(Proc, name), sizeof(type) },
+    PROC_FIELDS
+#undef PROC_FIELD
+};
+
+#define SAVE_FELD_CNT (sizeof(g_save_flds) / sizeof(Hfld))
+#define SAVE_HEAD_LEN (sizeof(Head) + sizeof(g_save_flds) + sizeof(Hsec) * CORE_COUNT)
 #endif
 
-bool mvec_is_alloc(const Core *core, u64 addr) {
-    assert(core);
-#ifdef MVEC_LOOP
-    return core->mvec[mvec_loop(addr)] & MALL_FLAG ? true : false;
-#else
-    if (addr < MVEC_SIZE) {
-        return core->mvec[addr] & MALL_FLAG ? true : false;
-    } else {
-        return true;
-    }
+#if ACTION == ACT_BENCH || ACTION == ACT_NEW
+char g_mnemo_table[0x100][MNEMONIC_BUFF_SIZE];
 #endif
-}
 
-void mvec_alloc(Core *core, u64 addr) {
-    assert(core);
-    assert(!mvec_is_alloc(core, addr));
-#ifdef MVEC_LOOP
-    core->mvec[mvec_loop(addr)] |= MALL_FLAG;
+#if PHASE_TIMING == 1
+// Reads the time stamp counter, falling back to the monotonic clock (in
+// nanoseconds) on machines without one
+u64 phase_tsc() {
+#ifdef __x86_64__
+    return __builtin_ia32_rdtsc();
 #else
-    assert(addr < MVEC_SIZE);
-    core->mvec[addr] |= MALL_FLAG;
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + (u64)ts.tv_nsec;
 #endif
-    core->mall++;
 }
 
-void mvec_free(Core *core, u64 addr) {
-    assert(core);
-    assert(mvec_is_alloc(core, addr));
-#ifdef MVEC_LOOP
-    core->mvec[mvec_loop(addr)] ^= MALL_FLAG;
-#else
-    assert(addr < MVEC_SIZE);
-    core->mvec[addr] ^= MALL_FLAG;
-#endif
-    core->mall--;
+void phase_add(Phtm *phtm, u64 cycs) {
+    assert(phtm);
+
+    phtm->cnt++;
+    phtm->cycs += cycs;
+    phtm->hist[cycs ? 63 - __builtin_clzl(cycs) : 0]++;
 }
+#endif
 
-u8 mvec_get_byte(const Core *core, u64 addr) {
+#if PERF_EVENTS == 1
+const char *g_prfc_names[] = {
+#define PERF_EVENT(name, desc, type, conf) desc,
+    PERF_EVENT_LIST
+#undef PERF_EVENT
+};
+
+// Opens all events on the calling thread, counting user space only, so that
+// restrictive 'perf_event_paranoid' settings still allow them. Core threads
+// get recreated at every sync, so events get opened on each run.
+void perf_open(Core *core, int *pfds) {
     assert(core);
-#ifdef MVEC_LOOP
-    return core->mvec[mvec_loop(addr)];
-#else
-    if (addr < MVEC_SIZE) {
-        return core->mvec[addr];
-    } else {
-        return 0;
+    assert(pfds);
+
+    const u64 type[] = {
+#define PERF_EVENT(name, desc, type, conf) type,
+        PERF_EVENT_LIST
+#undef PERF_EVENT
+    };
+
+    const u64 conf[] = {
+#define PERF_EVENT(name, desc, type, conf) conf,
+        PERF_EVENT_LIST
+#undef PERF_EVENT
+    };
+
+    for (int i = 0; i < PRFC_COUNT; ++i) {
+        struct perf_event_attr attr = {0};
+
+        attr.type           = (uint32_t)type[i];
+        attr.size           = sizeof(attr);
+        attr.config         = conf[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        pfds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+        if (pfds[i] < 0) {
+            core->prfu |= 1ul << i;
+        }
     }
-#endif
 }
 
-u8 mvec_get_inst(const Core *core, u64 addr) {
+// Adds counted events into the core's totals. Events sharing the PMU with
+// too many others only count part of the time, so counts get extrapolated.
+void perf_close(Core *core, const int *pfds) {
     assert(core);
-#ifdef MVEC_LOOP
-    return core->mvec[mvec_loop(addr)] & INST_MASK;
-#else
-    if (addr < MVEC_SIZE) {
-        return core->mvec[addr] & INST_MASK;
-    } else {
-        return 0;
+    assert(pfds);
+
+    for (int i = 0; i < PRFC_COUNT; ++i) {
+        u64 rval[3];
+
+        if (pfds[i] < 0) {
+            continue;
+        }
+
+        if (read(pfds[i], rval, sizeof(rval)) == sizeof(rval) && rval[2]) {
+            core->prfc[i] += (u64)((double)rval[0] * rval[1] / rval[2]);
+        }
+
+        close(pfds[i]);
     }
-#endif
 }
-
-void mvec_set_inst(Core *core, u64 addr, u8 inst) {
-    assert(core);
-    assert(inst < INST_CAPS);
-#ifdef MVEC_LOOP
-    core->mvec[mvec_loop(addr)] &= MALL_FLAG;
-    core->mvec[mvec_loop(addr)] |= inst;
-#else
-    assert(addr < MVEC_SIZE);
-    core->mvec[addr] &= MALL_FLAG;
-    core->mvec[addr] |= inst;
 #endif
-}
 
-#if MUTA_FLIP_BIT == 1
-void mvec_flip_bit(Core *core, u64 addr, int bit) {
-    assert(core);
-    assert(bit < 8);
-    core->mvec[addr] ^= (1 << bit) & INST_MASK;
+#ifdef MVEC_LOOP
+u64 mvec_loop(u64 addr) {
+    return addr % MVEC_SIZE;
 }
 #endif
 
-bool mvec_is_proc_owner(const Core *core, u64 addr, u64 pix) {
-    assert(core);
-    assert(proc_is_live(core, pix));
-
-    u64 mb0a = arch_proc_mb0_addr(core, pix);
-    u64 mb0s = arch_proc_mb0_size(core, pix);
-
-    if (((addr - mb0a) % MVEC_SIZE) < mb0s) {
-        return true;
-    }
+#if EVENT_LOG == 1 || PHYLO_LOG == 1
+// Returns the slot of the next record on 'ring', to be filled in place and
+// then published with strm_commit().
+void *strm_next(Strm *strm, int ring) {
+    assert(strm);
+    assert(ring >= 0 && ring <= CORE_COUNT);
 
-    u64 mb1a = arch_proc_mb1_addr(core, pix);
-    u64 mb1s = arch_proc_mb1_size(core, pix);
+    Ring *rng = &strm->ring[ring];
+    u64   head = atomic_load_explicit(&rng->head, memory_order_relaxed);
 
-    if (((addr - mb1a) % MVEC_SIZE) < mb1s) {
-        return true;
+    while (head - atomic_load_explicit(&rng->tail, memory_order_acquire) == STRM_RING_SIZE) {
+        thrd_yield();
     }
 
-    return false;
+    return &rng->data[(head & STRM_RING_MASK) * strm->rsiz];
 }
 
-u64 mvec_get_owner(const Core *core, u64 addr) {
-    assert(core);
-    assert(mvec_is_alloc(core, addr));
+void strm_commit(Strm *strm, int ring) {
+    assert(strm);
+    assert(ring >= 0 && ring <= CORE_COUNT);
 
-    for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
-        if (mvec_is_proc_owner(core, addr, pix)) {
-            return pix;
-        }
-    }
+    Ring *rng = &strm->ring[ring];
+    u64   head = atomic_load_explicit(&rng->head, memory_order_relaxed);
 
-    assert(false);
-    return -1;
+    atomic_store_explicit(&rng->head, head + 1, memory_order_release);
 }
 
-#if ACTION == ACT_BENCH || ACTION == ACT_NEW
-u64 muta_smix(u64 *seed) {
-    assert(seed);
+int strm_drain(Strm *strm) {
+    assert(strm);
 
-    u64 next = (*seed += 0x9e3779b97f4a7c15);
-    next     = (next ^ (next >> 30)) * 0xbf58476d1ce4e5b9;
-    next     = (next ^ (next >> 27)) * 0x94d049bb133111eb;
+    while (true) {
+        // producers are done once stop is raised, so one last pass drains all
+        bool stop  = atomic_load(&strm->stop);
+        u64  moved = 0;
 
-    return next ^ (next >> 31);
-}
-#endif
+        for (int i = 0; i <= CORE_COUNT; ++i) {
+            Ring *rng  = &strm->ring[i];
+            u64   head = atomic_load_explicit(&rng->head, memory_order_acquire);
+            u64   tail = atomic_load_explicit(&rng->tail, memory_order_relaxed);
 
-u64 muta_ro64(u64 x, int k) {
-    return (x << k) | (x >> (64 - k));
-}
+            while (tail != head) {
+                u64 tidx = tail & STRM_RING_MASK;
+                u64 tcnt = head - tail < STRM_RING_SIZE - tidx ? head - tail : STRM_RING_SIZE - tidx;
 
-u64 muta_next(Core *core) {
-    assert(core);
+                fwrite(&rng->data[tidx * strm->rsiz], strm->rsiz, tcnt, strm->file);
 
-    u64 r = muta_ro64(core->muta[1] * 5, 7) * 9;
-    u64 t = core->muta[1] << 17;
+                tail  += tcnt;
+                moved += tcnt;
 
-    core->muta[2] ^= core->muta[0];
-    core->muta[3] ^= core->muta[1];
-    core->muta[1] ^= core->muta[2];
-    core->muta[0] ^= core->muta[3];
+                atomic_store_explicit(&rng->tail, tail, memory_order_release);
+            }
+        }
 
-    core->muta[2] ^= t;
-    core->muta[3]  = muta_ro64(core->muta[3], 45);
+        if (stop) {
+            return 0;
+        }
 
-    return r;
+        if (!moved) {
+            thrd_sleep(&(struct timespec){ .tv_nsec = STRM_IDLE_NS }, NULL);
+        }
+    }
 }
 
-void muta_cosmic_ray(Core *core) {
-    assert(core);
+// Opens (or appends to) the stream file at 'path'. New files start with a
+// small header describing their records.
+void strm_open(Strm *strm, const char *path, const char *magc, u64 vers, u64 rsiz) {
+    assert(CORE_COUNT < 0x100);
+    assert(strm);
+    assert(path);
+    assert(magc);
+    assert(!strm->file);
+
+    strm->file = fopen(path, "ab");
+    strm->rsiz = rsiz;
+
+    assert(strm->file);
+
+    if (ftell(strm->file) == 0) {
+        u64 ccnt = CORE_COUNT;
+        u64 sync = SYNC_INTERVAL;
+
+        fwrite(magc, sizeof(char), 8, strm->file);
+        fwrite(&vers, sizeof(u64), 1, strm->file);
+        fwrite(&ccnt, sizeof(u64), 1, strm->file);
+        fwrite(&sync, sizeof(u64), 1, strm->file);
+        fwrite(&rsiz, sizeof(u64), 1, strm->file);
+    }
 
-    u64 a = muta_next(core) % MUTA_RANGE;
-    u64 b = muta_next(core);
+    for (int i = 0; i <= CORE_COUNT; ++i) {
+        strm->ring[i].data = calloc(STRM_RING_SIZE, rsiz);
+        assert(strm->ring[i].data);
+    }
 
-    if (a < MVEC_SIZE) {
-#if MUTA_FLIP_BIT == 1
-        mvec_flip_bit(core, a, (int)(b % 8));
-#else
-        mvec_set_inst(core, a, b & INST_MASK);
-#endif
+    atomic_store(&strm->stop, 0);
+    thrd_create(&strm->thread, (thrd_start_t)strm_drain, strm);
+}
+
+void strm_close(Strm *strm) {
+    assert(strm);
+    assert(strm->file);
+
+    atomic_store(&strm->stop, 1);
+    thrd_join(strm->thread, NULL);
+    fclose(strm->file);
+
+    for (int i = 0; i <= CORE_COUNT; ++i) {
+        free(strm->ring[i].data);
+
+        strm->ring[i].data = NULL;
+        atomic_store(&strm->ring[i].head, 0);
+        atomic_store(&strm->ring[i].tail, 0);
     }
+
+    strm->file = NULL;
 }
 
-void proc_new(Core *core, const Proc *proc) {
+// g_syncs stays constant while core threads run
+u64 core_step_now(const Core *core) {
     assert(core);
-    assert(proc);
+    return g_syncs * SYNC_INTERVAL + core->ivpt;
+}
+#endif
 
-    if (core->pnum == core->pcap) {
-        u64   new_pcap = core->pcap * 2;
-        Proc *new_pvec = calloc(new_pcap, sizeof(Proc));
+#if EVENT_LOG == 1
+void evnt_push(int ring, u8 kind, u64 step, u64 addr, u64 slot, u8 inst, u8 prev) {
+#if REWIND_RING > 0
+    // replayed events are already in the log
+    if (g_rply) {
+        return;
+    }
+#endif
 
-        for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
-            u64 iold = pix % core->pcap;
-            u64 inew = pix % new_pcap;
-            memcpy(&new_pvec[inew], &core->pvec[iold], sizeof(Proc));
-        }
+    Evnt *evnt = strm_next(&g_evnt_strm, ring);
 
-        free(core->pvec);
-        core->pcap = new_pcap;
-        core->pvec = new_pvec;
-    }
+    evnt->step = step;
+    evnt->addr = addr;
+    evnt->slot = (uint32_t)slot;
+    evnt->kind = kind;
+    evnt->core = (u8)ring;
+    evnt->inst = inst;
+    evnt->prev = prev;
 
-    core->pnum++;
-    core->plst++;
-    memcpy(&core->pvec[core->plst % core->pcap], proc, sizeof(Proc));
+    strm_commit(&g_evnt_strm, ring);
 }
 
-void proc_kill(Core *core) {
+void core_evnt(const Core *core, u8 kind, u64 addr, u8 inst, u8 prev) {
     assert(core);
-    assert(core->pnum > 1);
 
-    arch_on_proc_kill(core);
+    evnt_push((int)(core - g_cores), kind, core_step_now(core), addr, core->ivpt, inst, prev);
+}
+#endif
 
-    core->pcur++;
-    core->pfst++;
-    core->pnum--;
+#if STATE_DIGEST == 1
+/*
+ * State digests are XOR-of-hashes: every (index, value) cell of a buffer
+ * contributes one mixed hash, so a single write can be folded in or out in
+ * constant time. Empty cells contribute nothing, which lets zeroed buffers
+ * start with a digest of zero. Each part of the digest salts its indices,
+ * so equal cells in different parts don't cancel out when XORed together.
+ */
+#define DGST_SALT_MVEC (0x6a09e667f3bcc908ul)
+#define DGST_SALT_PROC (0xbb67ae8584caa73bul)
+#define DGST_SALT_MUTA (0x3c6ef372fe94f82bul)
+#define DGST_SALT_IPCM (0xa54ff53a5f1d36f1ul)
+
+u64 dgst_mix(u64 x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+
+    return x ^ (x >> 31);
 }
 
-bool proc_is_live(const Core *core, u64 pix) {
+u64 dgst_cell(u64 salt, u64 index, u64 value) {
+    if (!value) {
+        return 0;
+    }
+
+    return dgst_mix(((index ^ salt) * 0x9e3779b97f4a7c15) ^ dgst_mix(value));
+}
+
+u64 dgst_ipcm(u64 index, u8 inst, u64 addr) {
+    return dgst_cell(DGST_SALT_IPCM, index, dgst_mix(addr) ^ inst);
+}
+#endif
+
+u64 mvec_index(u64 addr) {
+#ifdef MVEC_LOOP
+    return mvec_loop(addr);
+#else
+    assert(addr < MVEC_SIZE);
+    return addr;
+#endif
+}
+
+#if HEAT_MAPS == 1
+// Counts one event into the bucket holding 'addr'
+void core_heat_add(Core *core, int kind, u64 addr) {
     assert(core);
+    assert(kind < HEAT_COUNT);
 
-    return pix >= core->pfst && pix <= core->plst;
+#if REWIND_RING > 0
+    // heatmaps aren't checkpointed, so replayed hits are already counted
+    if (g_rply) {
+        return;
+    }
+#endif
+
+    core->heat[kind][mvec_index(addr) >> HEAT_BUCKET_POW]++;
 }
 
-const Proc *proc_get(const Core *core, u64 pix) {
+// Samples one in HEAT_SAMPLE events. Sampling is periodic rather than
+// random, so it leaves the simulation's random state untouched.
+bool core_heat_tick(Core *core, int kind) {
     assert(core);
+    assert(kind < HEAT_COUNT);
 
-    if (proc_is_live(core, pix)) {
-        return &core->pvec[pix % core->pcap];
-    } else {
-        return &g_dead_proc;
+    if (++core->htcd[kind] < HEAT_SAMPLE) {
+        return false;
     }
+
+    core->htcd[kind] = 0;
+
+    return true;
 }
 
-Proc *proc_fetch(Core *core, u64 pix) {
+void core_heat(Core *core, int kind, u64 addr) {
     assert(core);
-    assert(proc_is_live(core, pix));
 
-    return &core->pvec[pix % core->pcap];
+    if (core_heat_tick(core, kind)) {
+        core_heat_add(core, kind, addr);
+    }
 }
+#endif
 
-#if ACTION == ACT_LOAD || ACTION == ACT_NEW
-void core_save(FILE *f, const Core *core) {
-    assert(f);
+void mvec_write(Core *core, u64 addr, u8 byte) {
     assert(core);
 
-    fwrite(&core->mall, sizeof(u64), 1, f);
-    fwrite( core->muta, sizeof(u64), 4, f);
-    fwrite(&core->pnum, sizeof(u64), 1, f);
-    fwrite(&core->pcap, sizeof(u64), 1, f);
-    fwrite(&core->pfst, sizeof(u64), 1, f);
-    fwrite(&core->plst, sizeof(u64), 1, f);
-    fwrite(&core->pcur, sizeof(u64), 1, f);
-    fwrite(&core->psli, sizeof(u64), 1, f);
-    fwrite(&core->ncyc, sizeof(u64), 1, f);
-    fwrite(&core->ivpt, sizeof(u64), 1, f);
+    u64 mix = mvec_index(addr);
 
-    fwrite(core->iviv, sizeof(u8),   SYNC_INTERVAL, f);
-    fwrite(core->ivav, sizeof(u64),  SYNC_INTERVAL, f);
-    fwrite(core->pvec, sizeof(Proc), core->pcap,    f);
-    fwrite(core->mvec, sizeof(u8),   MVEC_SIZE,     f);
-}
+#if STATE_DIGEST == 1
+    core->mvhs ^= dgst_cell(DGST_SALT_MVEC, mix, core->mvec[mix]) ^ dgst_cell(DGST_SALT_MVEC, mix, byte);
+#endif
+#if DELTA_BASE > 1
+    core->mdrt[mix >> MVEC_PAGE_POW] = 1;
 #endif
+    core->mvec[mix] = byte;
+}
 
-#if ACTION == ACT_BENCH || ACTION == ACT_NEW
-u64 core_assemble_ancestor(int cix, const char *anc) {
-    assert(cix >= 0 && cix < CORE_COUNT);
-    assert(anc);
+bool mvec_is_alloc(const Core *core, u64 addr) {
+    assert(core);
+#ifdef MVEC_LOOP
+    return core->mvec[mvec_loop(addr)] & MALL_FLAG ? true : false;
+#else
+    if (addr < MVEC_SIZE) {
+        return core->mvec[addr] & MALL_FLAG ? true : false;
+    } else {
+        return true;
+    }
+#endif
+}
 
-    if (anc[0] == '_') {
+u8 mvec_get_byte(const Core *core, u64 addr) {
+    assert(core);
+#ifdef MVEC_LOOP
+    return core->mvec[mvec_loop(addr)];
+#else
+    if (addr < MVEC_SIZE) {
+        return core->mvec[addr];
+    } else {
         return 0;
     }
+#endif
+}
 
-    FILE *f = fopen(anc, "r");
+void mvec_alloc(Core *core, u64 addr) {
+    assert(core);
+    assert(!mvec_is_alloc(core, addr));
+    mvec_write(core, addr, core->mvec[mvec_index(addr)] | MALL_FLAG);
+    core->mall++;
+}
 
-    assert(f);
+void mvec_free(Core *core, u64 addr) {
+    assert(core);
+    assert(mvec_is_alloc(core, addr));
+    mvec_write(core, addr, core->mvec[mvec_index(addr)] ^ MALL_FLAG);
+    core->mall--;
+}
 
-#if ANC_HALF == 1
-    u64 addr = U64_HALF;
+u8 mvec_get_inst(const Core *core, u64 addr) {
+    assert(core);
+#ifdef MVEC_LOOP
+    return core->mvec[mvec_loop(addr)] & INST_MASK;
 #else
-    u64 addr = 0;
+    if (addr < MVEC_SIZE) {
+        return core->mvec[addr] & INST_MASK;
+    } else {
+        return 0;
+    }
 #endif
+}
 
-    char  line[ASM_LINE_LEN] = {0};
-    Core *core               = &g_cores[cix];
+void mvec_set_inst(Core *core, u64 addr, u8 inst) {
+    assert(core);
+    assert(inst < INST_CAPS);
+    mvec_write(core, addr, (core->mvec[mvec_index(addr)] & MALL_FLAG) | inst);
+}
 
-    for (; fgets(line, ASM_LINE_LEN, f); ++addr) {
-#ifndef NDEBUG
-        bool line_ok = false;
+#if MUTA_FLIP_BIT == 1
+void mvec_flip_bit(Core *core, u64 addr, int bit) {
+    assert(core);
+    assert(bit < 8);
+    mvec_write(core, addr, core->mvec[mvec_index(addr)] ^ ((1 << bit) & INST_MASK));
+}
 #endif
 
-        line[strcspn(line, "\r\n")] = '\0';
+bool mvec_is_proc_owner(const Core *core, u64 addr, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
 
-        for (int i = 0; i < 0x100; ++i) {
-            if (strcmp(line, g_mnemo_table[i]) == 0) {
-                for (u64 j = 0; j < ANC_CLONES; ++j) {
-                    u64 addr_clone = addr + ((MVEC_SIZE / ANC_CLONES) * j);
+    u64 mb0a = arch_proc_mb0_addr(core, pix);
+    u64 mb0s = arch_proc_mb0_size(core, pix);
 
-                    mvec_alloc(core, addr_clone);
-                    mvec_set_inst(core, addr_clone, i);
-                }
+    if (((addr - mb0a) % MVEC_SIZE) < mb0s) {
+        return true;
+    }
 
-#ifndef NDEBUG
-                line_ok = true;
-#endif
-                break;
-            }
+    u64 mb1a = arch_proc_mb1_addr(core, pix);
+    u64 mb1s = arch_proc_mb1_size(core, pix);
+
+    if (((addr - mb1a) % MVEC_SIZE) < mb1s) {
+        return true;
+    }
+
+    return false;
+}
+
+u64 mvec_get_owner(const Core *core, u64 addr) {
+    assert(core);
+    assert(mvec_is_alloc(core, addr));
+
+    for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
+        if (mvec_is_proc_owner(core, addr, pix)) {
+            return pix;
         }
+    }
 
-        assert(line_ok);
+    assert(false);
+    return -1;
+}
+
+// FNV-1a over the instructions of a memory block, used to identify genomes
+u64 mvec_hash(const Core *core, u64 addr, u64 size) {
+    assert(core);
+
+    u64 hash = 0xcbf29ce484222325;
+
+    for (u64 i = 0; i < size; ++i) {
+        hash ^= mvec_get_inst(core, addr + i);
+        hash *= 0x100000001b3;
     }
 
-    fclose(f);
+    return hash;
+}
 
-    return addr;
+#if GENOME_CENSUS == 1
+void cens_init(Cens *cens) {
+    assert(cens);
+
+    cens->gcap = CENS_INIT_CAP;
+    cens->hcap = CENS_INIT_CAP * 2;
+    cens->fcap = CENS_INIT_CAP;
+    cens->acap = CENS_INIT_CAP * 0x10;
+    cens->gbsz = CENS_INIT_CAP;
+    cens->gvec = malloc(cens->gcap * sizeof(Cgen));
+    cens->htab = calloc(cens->hcap, sizeof(u64));
+    cens->rank = malloc(cens->gcap * sizeof(u64));
+    cens->frst = calloc(cens->fcap, sizeof(u64));
+    cens->arna = malloc(cens->acap);
+    cens->gbuf = malloc(cens->gbsz);
+
+    assert(cens->gvec);
+    assert(cens->htab);
+    assert(cens->rank);
+    assert(cens->frst);
+    assert(cens->arna);
+    assert(cens->gbuf);
 }
 
-void core_init(int cix, u64 *seed, const char *anc) {
-    assert(cix >= 0 && cix < CORE_COUNT);
-    assert(seed);
-    assert(anc);
+void cens_free(Cens *cens) {
+    assert(cens);
 
-    Core *core = &g_cores[cix];
+    free(cens->gvec);
+    free(cens->htab);
+    free(cens->rank);
+    free(cens->frst);
+    free(cens->arna);
+    free(cens->gbuf);
 
-    if (*seed) {
-        core->muta[0] = muta_smix(seed);
-        core->muta[1] = muta_smix(seed);
-        core->muta[2] = muta_smix(seed);
-        core->muta[3] = muta_smix(seed);
+    memset(cens, 0, sizeof(Cens));
+}
+
+// Returns the table slot holding the given genome, or the empty slot where
+// it would go
+u64 *cens_slot(const Cens *cens, const u8 *gene, u64 size, u64 hash) {
+    assert(cens);
+    assert(gene || !size);
+
+    u64 mask = cens->hcap - 1;
+
+    for (u64 i = hash & mask;; i = (i + 1) & mask) {
+        u64 *slot = &cens->htab[i];
+
+        if (!*slot) {
+            return slot;
+        }
+
+        const Cgen *cgen = &cens->gvec[*slot - 1];
+
+        if (cgen->hash == hash && cgen->size == size && !memcmp(&cens->arna[cgen->offs], gene, size)) {
+            return slot;
+        }
     }
+}
 
-    core->pnum = ANC_CLONES;
-    core->pcap = ANC_CLONES;
-    core->plst = ANC_CLONES - 1;
-    core->iviv = calloc(SYNC_INTERVAL, sizeof(u8));
-    core->ivav = calloc(SYNC_INTERVAL, sizeof(u64));
-    core->pvec = calloc(core->pcap, sizeof(Proc));
+void cens_rehash(Cens *cens) {
+    assert(cens);
 
-    assert(core->iviv);
-    assert(core->ivav);
-    assert(core->pvec);
+    memset(cens->htab, 0, cens->hcap * sizeof(u64));
 
-    u64 anc_size = core_assemble_ancestor(cix, anc);
+    for (u64 i = 0; i < cens->gnum; ++i) {
+        const Cgen *cgen = &cens->gvec[i];
 
-#if ANC_HALF == 1
-    anc_size -= U64_HALF;
+        *cens_slot(cens, &cens->arna[cgen->offs], cgen->size, cgen->hash) = i + 1;
+    }
+}
+
+// Drops extinct genotypes, keeping the live ones in rank order. Processes
+// refer to genotypes by index, so references of those already counted (all
+// before 'pend') get remapped.
+void core_cens_compact(Core *core, u64 pend) {
+    assert(core);
+
+    Cens *cens = &core->cens;
+
+    u64   live = cens->frst[0];
+    u64  *rmap = malloc(cens->gnum * sizeof(u64));
+    Cgen *gvec = malloc(cens->gcap * sizeof(Cgen));
+    u8   *arna = malloc(cens->acap);
+    u64   asiz = 0;
+
+    assert(rmap);
+    assert(gvec);
+    assert(arna);
+
+    for (u64 i = 0; i < live; ++i) {
+        const Cgen *cgen = &cens->gvec[cens->rank[i]];
+
+        gvec[i]      = *cgen;
+        gvec[i].offs = asiz;
+        gvec[i].rank = i;
+
+        memcpy(&arna[asiz], &cens->arna[cgen->offs], cgen->size);
+
+        asiz                += cgen->size;
+        rmap[cens->rank[i]]  = i;
+        cens->rank[i]        = i;
+    }
+
+    for (u64 pix = core->pfst; pix < pend; ++pix) {
+        core->pgid[pix % core->pcap] = rmap[core->pgid[pix % core->pcap]];
+    }
+
+    free(rmap);
+    free(cens->gvec);
+    free(cens->arna);
+
+    cens->gvec = gvec;
+    cens->arna = arna;
+    cens->asiz = asiz;
+    cens->gnum = live;
+
+    cens_rehash(cens);
+}
+
+// Appends a new genotype, with no count, making room for it first. Full
+// censuses holding mostly extinct genotypes get compacted instead of grown.
+u64 core_cens_intern(Core *core, u64 pend, u64 size, u64 hash) {
+    assert(core);
+
+    Cens *cens = &core->cens;
+
+    if (cens->gnum == cens->gcap) {
+        if ((cens->gnum - cens->frst[0]) * 2 >= cens->gnum) {
+            core_cens_compact(core, pend);
+        } else {
+            cens->gcap *= 2;
+            cens->gvec  = realloc(cens->gvec, cens->gcap * sizeof(Cgen));
+            cens->rank  = realloc(cens->rank, cens->gcap * sizeof(u64));
+
+            assert(cens->gvec);
+            assert(cens->rank);
+        }
+    }
+
+    if ((cens->gnum + 1) * 2 > cens->hcap) {
+        free(cens->htab);
+
+        cens->hcap *= 2;
+        cens->htab  = calloc(cens->hcap, sizeof(u64));
+
+        assert(cens->htab);
+
+        cens_rehash(cens);
+    }
+
+    while (cens->asiz + size > cens->acap) {
+        cens->acap *= 2;
+        cens->arna  = realloc(cens->arna, cens->acap);
+
+        assert(cens->arna);
+    }
+
+    u64   gid  = cens->gnum++;
+    Cgen *cgen = &cens->gvec[gid];
+
+    cgen->hash = hash;
+    cgen->size = size;
+    cgen->offs = cens->asiz;
+    cgen->cnt  = 0;
+    cgen->rank = gid;
+
+    memcpy(&cens->arna[cgen->offs], cens->gbuf, size);
+
+    cens->asiz      += size;
+    cens->rank[gid]  = gid;
+
+    *cens_slot(cens, cens->gbuf, size, hash) = gid + 1;
+
+    return gid;
+}
+
+void cens_swap(Cens *cens, u64 gid, u64 rank) {
+    assert(cens);
+    assert(gid < cens->gnum);
+    assert(rank < cens->gnum);
+
+    u64 oid = cens->rank[rank];
+
+    cens->rank[cens->gvec[gid].rank] = oid;
+    cens->gvec[oid].rank             = cens->gvec[gid].rank;
+    cens->rank[rank]                 = gid;
+    cens->gvec[gid].rank             = rank;
+}
+
+void cens_incr(Cens *cens, u64 gid) {
+    assert(cens);
+    assert(gid < cens->gnum);
+
+    u64 cnt = cens->gvec[gid].cnt;
+
+    if (cnt + 1 >= cens->fcap) {
+        cens->frst = realloc(cens->frst, cens->fcap * 2 * sizeof(u64));
+
+        assert(cens->frst);
+
+        memset(&cens->frst[cens->fcap], 0, cens->fcap * sizeof(u64));
+
+        cens->fcap *= 2;
+    }
+
+    cens_swap(cens, gid, cens->frst[cnt]++);
+
+    cens->gvec[gid].cnt++;
+    cens->sqrs += cnt * 2 + 1;
+    cens->pnum++;
+}
+
+void cens_decr(Cens *cens, u64 gid) {
+    assert(cens);
+    assert(gid < cens->gnum);
+    assert(cens->gvec[gid].cnt);
+
+    u64 cnt = cens->gvec[gid].cnt;
+
+    cens_swap(cens, gid, --cens->frst[cnt - 1]);
+
+    cens->gvec[gid].cnt--;
+    cens->sqrs -= cnt * 2 - 1;
+    cens->pnum--;
+}
+
+// Counts process 'pix' under the genotype of its first memory block. Hashes
+// match the ones found in phylogeny logs and listed by the genomes tool.
+void core_cens_add(Core *core, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+
+    Cens *cens = &core->cens;
+    u64   addr = arch_proc_mb0_addr(core, pix);
+    u64   size = arch_proc_mb0_size(core, pix);
+    u64   hash = 0xcbf29ce484222325;
+
+    if (size > cens->gbsz) {
+        cens->gbsz = size;
+        cens->gbuf = realloc(cens->gbuf, size);
+
+        assert(cens->gbuf);
+    }
+
+    for (u64 i = 0; i < size; ++i) {
+        cens->gbuf[i] = mvec_get_inst(core, addr + i);
+
+        hash ^= cens->gbuf[i];
+        hash *= 0x100000001b3;
+    }
+
+    u64 *slot = cens_slot(cens, cens->gbuf, size, hash);
+    u64  gid  = *slot ? *slot - 1 : core_cens_intern(core, pix, size, hash);
+
+    core->pgid[pix % core->pcap] = gid;
+
+    cens_incr(cens, gid);
+}
+
+void core_cens_del(Core *core, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+
+    cens_decr(&core->cens, core->pgid[pix % core->pcap]);
+}
+
+// Builds the census from scratch, out of all live processes
+void core_cens_build(Core *core) {
+    assert(core);
+
+    cens_free(&core->cens);
+    cens_init(&core->cens);
+    free(core->pgid);
+
+    core->pgid = malloc(core->pcap * sizeof(u64));
+
+    assert(core->pgid);
+
+    for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
+        core_cens_add(core, pix);
+    }
+}
+#endif
+
+#if ACTION == ACT_BENCH || ACTION == ACT_NEW
+u64 muta_smix(u64 *seed) {
+    assert(seed);
+
+    u64 next = (*seed += 0x9e3779b97f4a7c15);
+    next     = (next ^ (next >> 30)) * 0xbf58476d1ce4e5b9;
+    next     = (next ^ (next >> 27)) * 0x94d049bb133111eb;
+
+    return next ^ (next >> 31);
+}
+#endif
+
+u64 muta_ro64(u64 x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+u64 muta_next(Core *core) {
+    assert(core);
+
+    u64 r = muta_ro64(core->muta[1] * 5, 7) * 9;
+    u64 t = core->muta[1] << 17;
+
+    core->muta[2] ^= core->muta[0];
+    core->muta[3] ^= core->muta[1];
+    core->muta[1] ^= core->muta[2];
+    core->muta[0] ^= core->muta[3];
+
+    core->muta[2] ^= t;
+    core->muta[3]  = muta_ro64(core->muta[3], 45);
+
+    return r;
+}
+
+void muta_cosmic_ray(Core *core) {
+    assert(core);
+
+    u64 a = muta_next(core) % MUTA_RANGE;
+    u64 b = muta_next(core);
+
+    if (a < MVEC_SIZE) {
+#if EVENT_LOG == 1
+        u8 prev = mvec_get_byte(core, a);
+#endif
+
+#if MUTA_FLIP_BIT == 1
+        mvec_flip_bit(core, a, (int)(b % 8));
+#else
+        mvec_set_inst(core, a, b & INST_MASK);
+#endif
+
+#if HEAT_MAPS == 1
+        core_heat_add(core, HEAT_CRAY, a);
+#endif
+
+#if EVENT_LOG == 1
+        core_evnt(core, EVNT_MUTA, a, mvec_get_byte(core, a), prev);
+#endif
+    }
+}
+
+#if PHYLO_LOG == 1
+void core_phyl(const Core *core, u8 kind, u64 pix, u64 prnt, u64 age, u8 flag) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+
+#if REWIND_RING > 0
+    // replayed births and deaths are already in the log
+    if (g_rply) {
+        return;
+    }
+#endif
+
+    int   ring = (int)(core - g_cores);
+    Phyl *phyl = strm_next(&g_phyl_strm, ring);
+    u64   addr = arch_proc_mb0_addr(core, pix);
+    u64   size = arch_proc_mb0_size(core, pix);
+
+    *phyl = (Phyl){
+        .step = core_step_now(core),
+        .pix  = pix,
+        .prnt = prnt,
+        .addr = addr,
+        .size = size,
+        .hash = kind == PHYL_BORN ? mvec_hash(core, addr, size) : 0,
+        .age  = age,
+        .kind = kind,
+        .core = (u8)ring,
+        .flag = flag,
+    };
+
+    strm_commit(&g_phyl_strm, ring);
+}
+#endif
+
+void proc_new(Core *core, const Proc *proc) {
+    assert(core);
+    assert(proc);
+
+    if (core->pnum == core->pcap) {
+        u64   new_pcap = core->pcap * 2;
+        Proc *new_pvec = calloc(new_pcap, sizeof(Proc));
+
+        for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
+            u64 iold = pix % core->pcap;
+            u64 inew = pix % new_pcap;
+            memcpy(&new_pvec[inew], &core->pvec[iold], sizeof(Proc));
+        }
+
+#if PHYLO_LOG == 1
+        u64 *new_pbst = calloc(new_pcap, sizeof(u64));
+
+        for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
+            new_pbst[pix % new_pcap] = core->pbst[pix % core->pcap];
+        }
+
+        free(core->pbst);
+        core->pbst = new_pbst;
+#endif
+
+#if GENOME_CENSUS == 1
+        u64 *new_pgid = malloc(new_pcap * sizeof(u64));
+
+        assert(new_pgid);
+
+        for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
+            new_pgid[pix % new_pcap] = core->pgid[pix % core->pcap];
+        }
+
+        free(core->pgid);
+        core->pgid = new_pgid;
+#endif
+
+        free(core->pvec);
+        core->pcap = new_pcap;
+        core->pvec = new_pvec;
+        core->pcpk = new_pcap > core->pcpk ? new_pcap : core->pcpk;
+        core->pgrw++;
+    }
+
+    core->pnum++;
+    core->plst++;
+    core->pnpk = core->pnum > core->pnpk ? core->pnum : core->pnpk;
+    memcpy(&core->pvec[core->plst % core->pcap], proc, sizeof(Proc));
+
+#if PHYLO_LOG == 1
+    // splits only happen while the parent is being stepped
+    core->pbst[core->plst % core->pcap] = core_step_now(core);
+    core_phyl(core, PHYL_BORN, core->plst, core->pcur, 0, 0);
+#endif
+
+#if GENOME_CENSUS == 1
+    core_cens_add(core, core->plst);
+#endif
+}
+
+void proc_kill(Core *core) {
+    assert(core);
+    assert(core->pnum > 1);
+
+#if PHYLO_LOG == 1
+    u64 born = core->pbst[core->pfst % core->pcap];
+    u64 step = core_step_now(core);
+
+    if (born == PHYL_NONE) {
+        core_phyl(core, PHYL_DEAD, core->pfst, PHYL_NONE, step - g_phyl_base, PHYL_FLAG_AGLB);
+    } else {
+        core_phyl(core, PHYL_DEAD, core->pfst, PHYL_NONE, step - born, 0);
+    }
+#endif
+
+#if GENOME_CENSUS == 1
+    core_cens_del(core, core->pfst);
+#endif
+
+    arch_on_proc_kill(core);
+
+    core->pcur++;
+    core->pfst++;
+    core->pnum--;
+}
+
+bool proc_is_live(const Core *core, u64 pix) {
+    assert(core);
+
+    return pix >= core->pfst && pix <= core->plst;
+}
+
+const Proc *proc_get(const Core *core, u64 pix) {
+    assert(core);
+
+    if (proc_is_live(core, pix)) {
+        return &core->pvec[pix % core->pcap];
+    } else {
+        return &g_dead_proc;
+    }
+}
+
+Proc *proc_fetch(Core *core, u64 pix) {
+    assert(core);
+    assert(proc_is_live(core, pix));
+
+    return &core->pvec[pix % core->pcap];
+}
+
+#if ACTION == ACT_LOAD || ACTION == ACT_NEW
+void core_save_state(FILE *f, const Core *core) {
+    assert(f);
+    assert(core);
+
+    fwrite(&core->mall, sizeof(u64), 1, f);
+    fwrite( core->muta, sizeof(u64), 4, f);
+    fwrite(&core->pnum, sizeof(u64), 1, f);
+    fwrite(&core->pcap, sizeof(u64), 1, f);
+    fwrite(&core->pfst, sizeof(u64), 1, f);
+    fwrite(&core->plst, sizeof(u64), 1, f);
+    fwrite(&core->pcur, sizeof(u64), 1, f);
+    fwrite(&core->psli, sizeof(u64), 1, f);
+    fwrite(&core->ncyc, sizeof(u64), 1, f);
+    fwrite(&core->ivpt, sizeof(u64), 1, f);
+}
+
+u64 core_ipcm_count(const Core *core) {
+    assert(core);
+
+    u64 ivnm = 0;
+
+    for (u64 i = 0; i < SYNC_INTERVAL; ++i) {
+        ivnm += (core->iviv[i] & IPCM_FLAG) ? 1 : 0;
+    }
+
+    return ivnm;
+}
+
+u64 core_raw_size(const Core *core) {
+    assert(core);
+
+    u64 size = CORE_STATE_SIZE;
+
+    size += sizeof(u64) + core_ipcm_count(core) * (sizeof(u64) + sizeof(u8) + sizeof(u64));
+    size += core->pnum * sizeof(Proc);
+    size += MVEC_SIZE;
+
+    return size;
+}
+
+/*
+ * Save checksums follow the XXH64 algorithm. They are computed over each
+ * core's logical state (registers, IPC buffers, live processes and memory
+ * vector) rather than over the file's bytes, so the same value validates a
+ * full save, a compressed save or a reconstructed delta chain.
+ */
+#define CSUM_PRM1 (0x9e3779b185ebca87)
+#define CSUM_PRM2 (0xc2b2ae3d27d4eb4f)
+#define CSUM_PRM3 (0x165667b19e3779f9)
+#define CSUM_PRM4 (0x85ebca77c2b2ae63)
+#define CSUM_PRM5 (0x27d4eb2f165667c5)
+
+u64 csum_read64(const u8 *data) {
+    u64 value;
+    memcpy(&value, data, sizeof(u64));
+    return value;
+}
+
+u64 csum_round(u64 acc, u64 input) {
+    acc += input * CSUM_PRM2;
+    acc  = muta_ro64(acc, 31);
+    return acc * CSUM_PRM1;
+}
+
+u64 csum_merge(u64 acc, u64 val) {
+    acc ^= csum_round(0, val);
+    return acc * CSUM_PRM1 + CSUM_PRM4;
+}
+
+u64 csum_data(const void *data, u64 size, u64 seed) {
+    assert(data || !size);
+
+    const u8 *ptr = data;
+    const u8 *end = ptr + size;
+    u64       acc;
+
+    if (size >= 32) {
+        // four independent lanes keep the multipliers busy
+        u64 v1 = seed + CSUM_PRM1 + CSUM_PRM2;
+        u64 v2 = seed + CSUM_PRM2;
+        u64 v3 = seed;
+        u64 v4 = seed - CSUM_PRM1;
+
+        for (; ptr + 32 <= end; ptr += 32) {
+            v1 = csum_round(v1, csum_read64(ptr));
+            v2 = csum_round(v2, csum_read64(ptr + 8));
+            v3 = csum_round(v3, csum_read64(ptr + 16));
+            v4 = csum_round(v4, csum_read64(ptr + 24));
+        }
+
+        acc = muta_ro64(v1, 1) + muta_ro64(v2, 7) + muta_ro64(v3, 12) + muta_ro64(v4, 18);
+        acc = csum_merge(acc, v1);
+        acc = csum_merge(acc, v2);
+        acc = csum_merge(acc, v3);
+        acc = csum_merge(acc, v4);
+    } else {
+        acc = seed + CSUM_PRM5;
+    }
+
+    acc += size;
+
+    for (; ptr + 8 <= end; ptr += 8) {
+        acc ^= csum_round(0, csum_read64(ptr));
+        acc  = muta_ro64(acc, 27) * CSUM_PRM1 + CSUM_PRM4;
+    }
+
+    if (ptr + 4 <= end) {
+        uint32_t word;
+        memcpy(&word, ptr, sizeof(word));
+
+        acc ^= (u64)word * CSUM_PRM1;
+        acc  = muta_ro64(acc, 23) * CSUM_PRM2 + CSUM_PRM3;
+        ptr += 4;
+    }
+
+    for (; ptr < end; ++ptr) {
+        acc ^= *ptr * CSUM_PRM5;
+        acc  = muta_ro64(acc, 11) * CSUM_PRM1;
+    }
+
+    acc ^= acc >> 33;
+    acc *= CSUM_PRM2;
+    acc ^= acc >> 29;
+    acc *= CSUM_PRM3;
+    acc ^= acc >> 32;
+
+    return acc;
+}
+
+u64 core_csum(const Core *core) {
+    assert(core);
+
+    u64 regs[] = {
+        core->mall,
+        core->muta[0],
+        core->muta[1],
+        core->muta[2],
+        core->muta[3],
+        core->pnum,
+        core->pcap,
+        core->pfst,
+        core->plst,
+        core->pcur,
+        core->psli,
+        core->ncyc,
+        core->ivpt,
+    };
+
+    // live processes may wrap around the end of the process ring
+    u64 pfix = core->pfst % core->pcap;
+    u64 pseg = core->pnum < core->pcap - pfix ? core->pnum : core->pcap - pfix;
+    u64 csum = csum_data(regs, sizeof(regs), 0);
+
+    csum = csum_data(core->iviv, SYNC_INTERVAL * sizeof(u8), csum);
+    csum = csum_data(core->ivav, SYNC_INTERVAL * sizeof(u64), csum);
+    csum = csum_data(&core->pvec[pfix], pseg * sizeof(Proc), csum);
+    csum = csum_data(core->pvec, (core->pnum - pseg) * sizeof(Proc), csum);
+    csum = csum_data(core->mvec, MVEC_SIZE, csum);
+
+    return csum;
+}
+
+int core_csum_job(Pack *pack) {
+    assert(pack);
+    assert(pack->core);
+
+    pack->csum = core_csum(pack->core);
+
+    return 0;
+}
+
+void core_sect_align(FILE *f) {
+    assert(f);
+
+    long pos = ftell(f);
+
+    assert(pos >= 0);
+
+#ifndef NDEBUG
+    int res = fseek(f, (SAVE_SECT_ALGN - pos % SAVE_SECT_ALGN) % SAVE_SECT_ALGN, SEEK_CUR);
+#else
+    fseek(f, (SAVE_SECT_ALGN - pos % SAVE_SECT_ALGN) % SAVE_SECT_ALGN, SEEK_CUR);
+#endif
+
+    assert(res == 0);
+}
+
+/*
+ * All saves store the core's state registers, followed by only its occupied
+ * IPC slots and only its live processes. Dead processes and empty slots are
+ * rebuilt as zeros on load, so this part scales with the live state.
+ */
+void core_save_live(FILE *f, const Core *core) {
+    assert(f);
+    assert(core);
+
+    core_save_state(f, core);
+
+    u64 ivnm = core_ipcm_count(core);
+
+    fwrite(&ivnm, sizeof(u64), 1, f);
+
+    for (u64 i = 0; i < SYNC_INTERVAL; ++i) {
+        if (core->iviv[i] & IPCM_FLAG) {
+            fwrite(&i,             sizeof(u64), 1, f);
+            fwrite(&core->iviv[i], sizeof(u8),  1, f);
+            fwrite(&core->ivav[i], sizeof(u64), 1, f);
+        }
+    }
+
+    for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
+        fwrite(&core->pvec[pix % core->pcap], sizeof(Proc), 1, f);
+    }
+}
+
+// Full (uncompressed) saves start the memory vector at a page aligned
+// offset, so that loads can map it straight from the file.
+void core_save(FILE *f, const Core *core) {
+    assert(f);
+    assert(core);
+
+    core_save_live(f, core);
+    core_sect_align(f);
+
+    fwrite(core->mvec, sizeof(u8), MVEC_SIZE, f);
+}
+
+#if SAVE_COMPRESS == 1
+/*
+ * Compressed saves store the memory vector packed, prefixed by its packed
+ * size. Cores get packed in parallel, each one on its own thread.
+ */
+int core_pack(Pack *pack) {
+    assert(pack);
+    assert(pack->core);
+
+    core_csum_job(pack);
+
+    if (!pack->cmpr) {
+        return 0;
+    }
+
+    // untouched pages of the bound are never faulted in
+    pack->data = malloc(sizeof(u64) + codec_bound(MVEC_SIZE));
+
+    assert(pack->data);
+
+    u64 csiz = codec_pack(pack->core->mvec, MVEC_SIZE, &pack->data[sizeof(u64)]);
+
+    memcpy(pack->data, &csiz, sizeof(u64));
+    pack->size = sizeof(u64) + csiz;
+
+    return 0;
+}
+#endif
+
+#if DELTA_BASE > 1
+u64 mvec_page_size(u64 page) {
+    assert(page < MVEC_PAGE_CNT);
+
+    u64 addr = page << MVEC_PAGE_POW;
+
+    return MVEC_SIZE - addr < MVEC_PAGE_SIZE ? MVEC_SIZE - addr : MVEC_PAGE_SIZE;
+}
+
+/*
+ * Delta checkpoints store the core's live state followed by only the memory
+ * pages that were written since the previous checkpoint.
+ */
+void core_save_delta(FILE *f, const Core *core) {
+    assert(f);
+    assert(core);
+
+    core_save_live(f, core);
+
+    u64 pgnm = 0;
+
+    for (u64 i = 0; i < MVEC_PAGE_CNT; ++i) {
+        pgnm += core->mdrt[i];
+    }
+
+    fwrite(&pgnm, sizeof(u64), 1, f);
+
+    for (u64 i = 0; i < MVEC_PAGE_CNT; ++i) {
+        if (core->mdrt[i]) {
+            fwrite(&i, sizeof(u64), 1, f);
+            fwrite(&core->mvec[i << MVEC_PAGE_POW], sizeof(u8), mvec_page_size(i), f);
+        }
+    }
+}
+#endif
+#endif
+
+#if ACTION == ACT_BENCH || ACTION == ACT_NEW
+u64 core_assemble_ancestor(int cix, const char *anc) {
+    assert(cix >= 0 && cix < CORE_COUNT);
+    assert(anc);
+
+    if (anc[0] == '_') {
+        return 0;
+    }
+
+    FILE *f = fopen(anc, "r");
+
+    assert(f);
+
+#if ANC_HALF == 1
+    u64 addr = U64_HALF;
+#else
+    u64 addr = 0;
+#endif
+
+    char  line[ASM_LINE_LEN] = {0};
+    Core *core               = &g_cores[cix];
+
+    for (; fgets(line, ASM_LINE_LEN, f); ++addr) {
+#ifndef NDEBUG
+        bool line_ok = false;
+#endif
+
+        line[strcspn(line, "\r\n")] = '\0';
+
+        for (int i = 0; i < 0x100; ++i) {
+            if (strcmp(line, g_mnemo_table[i]) == 0) {
+                for (u64 j = 0; j < ANC_CLONES; ++j) {
+                    u64 addr_clone = addr + ((MVEC_SIZE / ANC_CLONES) * j);
+
+                    mvec_alloc(core, addr_clone);
+                    mvec_set_inst(core, addr_clone, i);
+                }
+
+#ifndef NDEBUG
+                line_ok = true;
+#endif
+                break;
+            }
+        }
+
+        assert(line_ok);
+    }
+
+    fclose(f);
+
+    return addr;
+}
+
+void core_init(int cix, u64 *seed, const char *anc) {
+    assert(cix >= 0 && cix < CORE_COUNT);
+    assert(seed);
+    assert(anc);
+
+    Core *core = &g_cores[cix];
+
+    if (*seed) {
+        core->muta[0] = muta_smix(seed);
+        core->muta[1] = muta_smix(seed);
+        core->muta[2] = muta_smix(seed);
+        core->muta[3] = muta_smix(seed);
+    }
+
+    core->pnum = ANC_CLONES;
+    core->pcap = ANC_CLONES;
+    core->plst = ANC_CLONES - 1;
+    core->pnpk = ANC_CLONES;
+    core->pcpk = ANC_CLONES;
+    core->iviv = calloc(SYNC_INTERVAL, sizeof(u8));
+    core->ivav = calloc(SYNC_INTERVAL, sizeof(u64));
+    core->pvec = calloc(core->pcap, sizeof(Proc));
+
+    assert(core->iviv);
+    assert(core->ivav);
+    assert(core->pvec);
+
+#if PHYLO_LOG == 1
+    core->pbst = calloc(core->pcap, sizeof(u64));
+    assert(core->pbst);
+#endif
+
+    u64 anc_size = core_assemble_ancestor(cix, anc);
+
+#if ANC_HALF == 1
+    anc_size -= U64_HALF;
+#endif
+
+    arch_anc_init(core, anc_size);
+}
+#endif
+
+#if ACTION == ACT_LOAD || REWIND_RING > 0
+/*
+ * Loaders read saves, which are user input, so they check every read and
+ * the consistency of what they read in optimized builds too. They return
+ * false on truncated or corrupt sections, leaving the caller to report it.
+ */
+bool core_read(FILE *f, void *data, u64 size, u64 nmem) {
+    assert(f);
+    assert(data || !nmem);
+
+    return fread(data, size, nmem, f) == nmem;
+}
+
+bool core_load_state(FILE *f, Core *core) {
+    assert(f);
+    assert(core);
+
+    bool okay = true;
+
+    okay = okay && core_read(f, &core->mall, sizeof(u64), 1);
+    okay = okay && core_read(f,  core->muta, sizeof(u64), 4);
+    okay = okay && core_read(f, &core->pnum, sizeof(u64), 1);
+    okay = okay && core_read(f, &core->pcap, sizeof(u64), 1);
+    okay = okay && core_read(f, &core->pfst, sizeof(u64), 1);
+    okay = okay && core_read(f, &core->plst, sizeof(u64), 1);
+    okay = okay && core_read(f, &core->pcur, sizeof(u64), 1);
+    okay = okay && core_read(f, &core->psli, sizeof(u64), 1);
+    okay = okay && core_read(f, &core->ncyc, sizeof(u64), 1);
+    okay = okay && core_read(f, &core->ivpt, sizeof(u64), 1);
+
+    // the process ring must be well formed before it gets indexed
+    okay = okay && core->mall <= MVEC_SIZE;
+    okay = okay && core->plst >= core->pfst;
+    okay = okay && core->pnum == core->plst + 1 - core->pfst;
+    okay = okay && core->pnum <= core->pcap;
+    okay = okay && core->pcur >= core->pfst && core->pcur <= core->plst;
+    okay = okay && core->ivpt < SYNC_INTERVAL;
+
+    if (!okay) {
+        return false;
+    }
+
+    // rewinds may shrink the process vector, so peaks are kept apart
+    core->pnpk = core->pnum > core->pnpk ? core->pnum : core->pnpk;
+    core->pcpk = core->pcap > core->pcpk ? core->pcap : core->pcpk;
+
+    return true;
+}
+
+// Rebuilds the process ring and the dense IPC buffers from their live
+// entries. Buffers left over from a parent checkpoint are reused.
+bool core_load_live(FILE *f, Core *core) {
+    assert(f);
+    assert(core);
+
+    if (!core_load_state(f, core)) {
+        return false;
+    }
+
+    free(core->pvec);
+
+    // a corrupt capacity may be too large to allocate
+    core->pvec = calloc(core->pcap, sizeof(Proc));
+
+    if (!core->pvec) {
+        return false;
+    }
+
+#if PHYLO_LOG == 1
+    // birth steps aren't saved, so restored processes start out unknown
+    free(core->pbst);
+
+    core->pbst = malloc(core->pcap * sizeof(u64));
+
+    if (!core->pbst) {
+        return false;
+    }
+
+    for (u64 i = 0; i < core->pcap; ++i) {
+        core->pbst[i] = PHYL_NONE;
+    }
+#endif
+
+    if (core->iviv) {
+        memset(core->iviv, 0, SYNC_INTERVAL * sizeof(u8));
+        memset(core->ivav, 0, SYNC_INTERVAL * sizeof(u64));
+    } else {
+        core->iviv = calloc(SYNC_INTERVAL, sizeof(u8));
+        core->ivav = calloc(SYNC_INTERVAL, sizeof(u64));
+    }
+
+    assert(core->iviv);
+    assert(core->ivav);
+
+    u64 ivnm = 0;
+
+    if (!core_read(f, &ivnm, sizeof(u64), 1) || ivnm > SYNC_INTERVAL) {
+        return false;
+    }
+
+    for (u64 i = 0; i < ivnm; ++i) {
+        u64 ivix = 0;
+
+        if (!core_read(f, &ivix, sizeof(u64), 1) || ivix >= SYNC_INTERVAL) {
+            return false;
+        }
+
+        if (!core_read(f, &core->iviv[ivix], sizeof(u8), 1) || !core_read(f, &core->ivav[ivix], sizeof(u64), 1)) {
+            return false;
+        }
+    }
+
+    for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
+        if (!core_read(f, &core->pvec[pix % core->pcap], sizeof(Proc), 1)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Maps the next 'size' bytes of the file privately into memory at 'addr'.
+// Pages get faulted in lazily, on first touch, and writes never reach the
+// file. Saves are always replaced via rename, so the mapped file contents
+// can't change beneath us either. Mapping past the end of the file would
+// only fault on first touch, so the range is checked against its size.
+bool core_load_map(FILE *f, void *addr, u64 size) {
+    assert(f);
+    assert(addr);
+    assert(size);
+
+    struct stat st;
+
+    long pos = ftell(f);
+
+    if (pos < 0 || pos % SAVE_SECT_ALGN != 0 || fstat(fileno(f), &st) || (u64)pos + size > (u64)st.st_size) {
+        return false;
+    }
+
+    void *data = mmap(addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fileno(f), pos);
+
+    if (data == MAP_FAILED || data != addr) {
+        return false;
+    }
+
+    if (fseek(f, pos + (long)size, SEEK_SET)) {
+        return false;
+    }
+
+    core_sect_align(f);
+
+    return true;
+}
+
+bool core_load(FILE *f, Core *core) {
+    assert(f);
+    assert(core);
+
+    if (!core_load_live(f, core)) {
+        return false;
+    }
+
+    core_sect_align(f);
+
+    // the memory vector is mapped in place, except for a trailing partial page
+    u64 tail = MVEC_SIZE % SAVE_SECT_ALGN;
+
+    if (MVEC_SIZE - tail && !core_load_map(f, core->mvec, MVEC_SIZE - tail)) {
+        return false;
+    }
+
+    return core_read(f, &core->mvec[MVEC_SIZE - tail], sizeof(u8), tail);
+}
+
+bool core_load_packed(FILE *f, Pack *pack) {
+    assert(f);
+    assert(pack);
+    assert(pack->core);
+
+    if (!core_load_live(f, pack->core)) {
+        return false;
+    }
+
+    u64 csiz = 0;
+
+    // packed streams never exceed the codec's bound, so larger sizes are
+    // corrupt, and never reach malloc
+    if (!core_read(f, &csiz, sizeof(u64), 1) || csiz > codec_bound(MVEC_SIZE)) {
+        return false;
+    }
+
+    pack->data = malloc(csiz ? csiz : 1);
+    pack->size = csiz;
+
+    assert(pack->data);
+
+    return core_read(f, pack->data, sizeof(u8), csiz);
+}
+
+// Returns non-zero if the packed memory vector is corrupt
+int core_unpack(Pack *pack) {
+    assert(pack);
+    assert(pack->core);
+    assert(pack->data);
+
+    bool okay = codec_unpack(pack->data, pack->size, pack->core->mvec, MVEC_SIZE);
+
+    free(pack->data);
+
+    pack->data = NULL;
+    pack->size = 0;
+
+    return okay ? 0 : 1;
+}
+
+#if DELTA_BASE > 1
+bool core_load_delta(FILE *f, Core *core) {
+    assert(f);
+    assert(core);
+    assert(core->iviv);
+    assert(core->ivav);
+    assert(core->pvec);
+
+    if (!core_load_live(f, core)) {
+        return false;
+    }
+
+    u64 pgnm = 0;
+
+    if (!core_read(f, &pgnm, sizeof(u64), 1) || pgnm > MVEC_PAGE_CNT) {
+        return false;
+    }
+
+    for (u64 i = 0; i < pgnm; ++i) {
+        u64 page = 0;
+
+        if (!core_read(f, &page, sizeof(u64), 1) || page >= MVEC_PAGE_CNT) {
+            return false;
+        }
+
+        if (!core_read(f, &core->mvec[page << MVEC_PAGE_POW], sizeof(u8), mvec_page_size(page))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+#endif
+
+void core_pull_ipcm(Core *core) {
+    assert(core);
+    assert(core->ivpt < SYNC_INTERVAL);
+
+    u8  *iinst = &core->iviv[core->ivpt];
+    u64 *iaddr = &core->ivav[core->ivpt];
+
+    if ((*iinst & IPCM_FLAG) != 0) {
+        mvec_set_inst(core, *iaddr, *iinst & INST_MASK);
+
+#if HEAT_MAPS == 1
+        core_heat(core, HEAT_WRTE, *iaddr);
+#endif
+
+#if EVENT_LOG == 1
+        core_evnt(core, EVNT_PULL, *iaddr, *iinst, 0);
+#endif
+
+#if STATS_LOG == 1
+        core->stpl++;
+#endif
+
+#if STATE_DIGEST == 1
+        core->ivhs ^= dgst_ipcm(core->ivpt, *iinst, *iaddr);
+#endif
+
+        *iinst = 0;
+        *iaddr = 0;
+    }
+
+    assert(*iinst == 0);
+    assert(*iaddr == 0);
+}
+
+void core_push_ipcm(Core *core, u8 inst, u64 addr) {
+    assert(core);
+    assert(core->ivpt < SYNC_INTERVAL);
+    assert((inst & IPCM_FLAG) == 0);
+
+    u8  *iinst = &core->iviv[core->ivpt];
+    u64 *iaddr = &core->ivav[core->ivpt];
+
+    assert(*iinst == 0);
+    assert(*iaddr == 0);
+
+    *iinst = inst | IPCM_FLAG;
+    *iaddr = addr;
+
+#if EVENT_LOG == 1
+    core_evnt(core, EVNT_PUSH, addr, *iinst, 0);
+#endif
+
+#if STATS_LOG == 1
+    core->stps++;
+#endif
+
+#if STATE_DIGEST == 1
+    core->ivhs ^= dgst_ipcm(core->ivpt, *iinst, *iaddr);
+#endif
+}
+
+void core_step(Core *core) {
+    assert(core);
+
+    if (core->psli != 0) {
+        core_pull_ipcm(core);
+
+#if HEAT_MAPS == 1
+        // fetch addresses are only looked up for sampled steps
+        if (core_heat_tick(core, HEAT_EXEC)) {
+            core_heat_add(core, HEAT_EXEC, arch_proc_ip_addr(core, core->pcur));
+        }
+#endif
+
+        arch_proc_step(core, core->pcur);
+
+        core->psli--;
+        core->ivpt++;
+
+        return;
+    }
+
+    if (core->pcur != core->plst) {
+        core->psli = arch_proc_slice(core, ++core->pcur);
+        core_step(core);
+        return;
+    }
+
+    core->pcur = core->pfst;
+    core->psli = arch_proc_slice(core, core->pcur);
+    core->ncyc++;
+
+#if PHASE_TIMING == 1
+    u64 beg = phase_tsc();
+#endif
+
+    while (core->mall > MVEC_SIZE / 2 && core->pnum > 1) {
+        proc_kill(core);
+    }
+
+#if PHASE_TIMING == 1
+    u64 mid = phase_tsc();
+
+    phase_add(&core->phtm[PHSC_reap], mid - beg);
+#endif
+
+    muta_cosmic_ray(core);
+
+#if PHASE_TIMING == 1
+    phase_add(&core->phtm[PHSC_cray], phase_tsc() - mid);
+#endif
+
+    core_step(core);
+}
+
+#if STATE_DIGEST == 1
+u64 core_digest_mvec(const Core *core) {
+    assert(core);
+
+    u64 mvhs = 0;
+
+    for (u64 i = 0; i < MVEC_SIZE; ++i) {
+        mvhs ^= dgst_cell(DGST_SALT_MVEC, i, core->mvec[i]);
+    }
+
+    return mvhs;
+}
+
+u64 core_digest_ipcm(const Core *core) {
+    assert(core);
+
+    u64 ivhs = 0;
+
+    for (u64 i = 0; i < SYNC_INTERVAL; ++i) {
+        ivhs ^= dgst_ipcm(i, core->iviv[i], core->ivav[i]);
+    }
+
+    return ivhs;
+}
+
+u64 core_digest_procs(const Core *core) {
+    assert(core);
+
+    u64 prhs = 0;
+    u64 fidx = 0;
+
+    prhs ^= dgst_cell(DGST_SALT_PROC, fidx++, core->mall);
+    prhs ^= dgst_cell(DGST_SALT_PROC, fidx++, core->pnum);
+    prhs ^= dgst_cell(DGST_SALT_PROC, fidx++, core->pfst);
+    prhs ^= dgst_cell(DGST_SALT_PROC, fidx++, core->plst);
+    prhs ^= dgst_cell(DGST_SALT_PROC, fidx++, core->pcur);
+    prhs ^= dgst_cell(DGST_SALT_PROC, fidx++, core->psli);
+    prhs ^= dgst_cell(DGST_SALT_PROC, fidx++, core->ncyc);
+    prhs ^= dgst_cell(DGST_SALT_PROC, fidx++, core->ivpt);
+
+    for (u64 pix = core->pfst; pix <= core->plst; ++pix) {
+        const Proc *proc = proc_get(core, pix);
+
+#define PROC_FIELD(type, name) prhs ^= dgst_cell(DGST_SALT_PROC, fidx++, dgst_mix(pix) ^ proc->name);
+        PROC_FIELDS
+#undef PROC_FIELD
+    }
+
+    return prhs;
+}
+
+u64 core_digest_muta(const Core *core) {
+    assert(core);
+
+    u64 muhs = 0;
+
+    for (u64 i = 0; i < 4; ++i) {
+        muhs ^= dgst_cell(DGST_SALT_MUTA, i, core->muta[i]);
+    }
+
+    return muhs;
+}
+
+void salis_digest_open() {
+    g_dgst_file = fopen(DIGEST_PATH, "a");
+
+    assert(g_dgst_file);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        g_cores[i].mvhs = core_digest_mvec(&g_cores[i]);
+        g_cores[i].ivhs = core_digest_ipcm(&g_cores[i]);
+    }
+}
+
+void salis_digest_close() {
+    assert(g_dgst_file);
+
+    fclose(g_dgst_file);
+
+    g_dgst_file = NULL;
+}
+
+void salis_digest_emit() {
+    assert(g_dgst_file);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        const Core *core = &g_cores[i];
+
+        u64 prhs = core_digest_procs(core);
+        u64 muhs = core_digest_muta(core);
+
+        fprintf(
+            g_dgst_file,
+            "%#018lx %#018lx %2d %#018lx %#018lx %#018lx %#018lx %#018lx\n",
+            g_steps,
+            g_syncs,
+            i,
+            core->mvhs ^ prhs ^ muhs ^ core->ivhs,
+            core->mvhs,
+            prhs,
+            muhs,
+            core->ivhs
+        );
+    }
+
+    fflush(g_dgst_file);
+}
+#endif
+
+#if PHYLO_LOG == 1
+// Marks a session boundary on every core's ring, so it stays ordered with
+// respect to that core's births and deaths. Processes with unknown birth
+// steps are aged from here on.
+void salis_phyl_mark() {
+    g_phyl_base = g_steps;
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        Phyl *phyl = strm_next(&g_phyl_strm, i);
+
+        *phyl = (Phyl){ .step = g_steps, .pix = PHYL_NONE, .prnt = PHYL_NONE, .kind = PHYL_OPEN, .core = (u8)i };
+
+        strm_commit(&g_phyl_strm, i);
+    }
+}
+
+void salis_phyl_open() {
+    strm_open(&g_phyl_strm, SIM_PATH PHYL_EXTN, PHYL_MAGIC, PHYL_VERSION, sizeof(Phyl));
+    salis_phyl_mark();
+}
+
+void salis_phyl_close() {
+    strm_close(&g_phyl_strm);
+}
+#endif
+
+#if EVENT_LOG == 1
+void salis_evnt_open() {
+    strm_open(&g_evnt_strm, EVENT_PATH, EVNT_MAGIC, EVNT_VERSION, sizeof(Evnt));
+    evnt_push(CORE_COUNT, EVNT_OPEN, g_steps, g_syncs, 0, 0, 0);
+}
+
+void salis_evnt_close() {
+    strm_close(&g_evnt_strm);
+}
+#endif
+
+u64 salis_clock_ns() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + (u64)ts.tv_nsec;
+}
+
+// Accounts for the last thread run of every core. The straggler is whichever
+// core computed for longest, while all others waited for it at the barrier.
+// Threads get started one after another, so waits are measured against
+// compute times, leaving thread startup skew out.
+void salis_sbar_update() {
+    u64 tbeg = (u64)-1;
+    u64 tend = 0;
+    int slow = 0;
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        Sbar *sbar = &g_cores[i].sbar;
+
+        sbar->cmpl = sbar->tend - sbar->tbeg;
+
+        tbeg = sbar->tbeg < tbeg ? sbar->tbeg : tbeg;
+        tend = sbar->tend > tend ? sbar->tend : tend;
+        slow = sbar->cmpl > g_cores[slow].sbar.cmpl ? i : slow;
+    }
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        Sbar *sbar = &g_cores[i].sbar;
+
+        sbar->watl  = g_cores[slow].sbar.cmpl - sbar->cmpl;
+        sbar->cmpt += sbar->cmpl;
+        sbar->watt += sbar->watl;
+
+        sbar->hist[sbar->watl ? 63 - __builtin_clzl(sbar->watl) : 0]++;
+    }
+
+    g_cores[slow].sbar.strg++;
+    g_sbar_runs++;
+    g_sbar_wall += tend - tbeg;
+}
+
+// Returns the core which was the straggler most often
+int salis_sbar_straggler() {
+    int slow = 0;
+
+    for (int i = 1; i < CORE_COUNT; ++i) {
+        if (g_cores[i].sbar.strg > g_cores[slow].sbar.strg) {
+            slow = i;
+        }
+    }
+
+    return slow;
+}
+
+// Share of all core time spent waiting at the barrier
+double salis_sbar_idle() {
+    u64 cmpt = 0;
+    u64 watt = 0;
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        cmpt += g_cores[i].sbar.cmpt;
+        watt += g_cores[i].sbar.watt;
+    }
+
+    return cmpt + watt ? (double)watt / (cmpt + watt) : 0.;
+}
+
+// Prints a one line summary, cheap enough to be printed at every sync
+void salis_sbar_report() {
+    int slow = salis_sbar_straggler();
+
+    printf(
+        "sync barrier: core %d straggled on %#lx of %#lx runs, %.2f%% of core time spent waiting\n",
+        slow,
+        g_cores[slow].sbar.strg,
+        g_sbar_runs,
+        salis_sbar_idle() * 100.
+    );
+}
+
+// Prints compute and wait totals of every core, with wait time histograms
+void salis_sbar_print() {
+    printf("sync barrier (%#lx runs, %.3f ms wall):\n", g_sbar_runs, g_sbar_wall / 1e6);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        const Sbar *sbar = &g_cores[i].sbar;
+
+        printf(
+            "    core %-3d compute %12.3f ms, wait %12.3f ms, straggler %#10lx\n        histogram:",
+            i,
+            sbar->cmpt / 1e6,
+            sbar->watt / 1e6,
+            sbar->strg
+        );
+
+        for (int j = 0; j < SBAR_HIST_LEN; ++j) {
+            if (sbar->hist[j]) {
+                printf(" 2^%d:%#lx", j, sbar->hist[j]);
+            }
+        }
+
+        putchar('\n');
+    }
+
+    salis_sbar_report();
+}
+
+#if STATS_LOG == 1
+// Wall clock time, comparable across sessions
+u64 salis_real_ns() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return (u64)ts.tv_sec * 1000000000 + (u64)ts.tv_nsec;
+}
+
+void salis_stat_head(FILE *f, u64 wdth) {
+    assert(f);
+
+    u64 vers = STAT_VERSION;
+    u64 sync = SYNC_INTERVAL;
+
+    fwrite(STAT_MAGIC, sizeof(char), 8, f);
+    fwrite(&vers, sizeof(u64), 1, f);
+    fwrite(&wdth, sizeof(u64), 1, f);
+    fwrite(&sync, sizeof(u64), 1, f);
+    fflush(f);
+}
+
+// Rewrites the row count in place, once all columns hold the new row
+void salis_stat_commit() {
+    assert(g_stat_rows);
+
+    fseek(g_stat_rows, STAT_HEAD_LEN, SEEK_SET);
+    fwrite(&g_stat_nrow, sizeof(u64), 1, g_stat_rows);
+    fflush(g_stat_rows);
+}
+
+/*
+ * Columns get flushed one after the other, so a reader (or a crash) may find
+ * them holding different row counts. The 'rows' file, with the usual header
+ * followed by a single value, holds the number of rows present in all
+ * columns, and is only updated after all of them. On open, rows past it get
+ * truncated away, so all columns stay aligned across sessions.
+ */
+void salis_stat_open() {
+    mkdir(SIM_PATH STAT_EXTN, 0755);
+
+    const char *names[] = {
+#define STAT_COLUMN(name, expr) #name,
+        STAT_GLOBAL_COLUMNS
+        STAT_CORE_COLUMNS
+#undef STAT_COLUMN
+    };
+
+    u64 nrow = (u64)-1;
+
+    g_stat_rows = fopen(STAT_ROWS, "r+b");
+
+    if (g_stat_rows) {
+        fseek(g_stat_rows, STAT_HEAD_LEN, SEEK_SET);
+
+        if (fread(&nrow, sizeof(u64), 1, g_stat_rows) != 1) {
+            nrow = (u64)-1;
+        }
+    } else {
+        g_stat_rows = fopen(STAT_ROWS, "w+b");
+
+        assert(g_stat_rows);
+
+        salis_stat_head(g_stat_rows, 1);
+    }
+
+    for (int i = 0; i < STAT_COL_COUNT; ++i) {
+        char path[STAT_NAME_LEN];
+        u64  wdth = i < STAT_GLOBAL_COUNT ? 1 : CORE_COUNT;
+
+        snprintf(path, STAT_NAME_LEN, "%s/%s", SIM_PATH STAT_EXTN, names[i]);
+
+        g_stat_files[i] = fopen(path, "ab");
+
+        assert(g_stat_files[i]);
+
+        long size = ftell(g_stat_files[i]);
+
+        if (size == 0) {
+            salis_stat_head(g_stat_files[i], wdth);
+            continue;
+        }
+
+        // complete rows only, in case a row was being written on a crash
+        u64 crow = ((u64)size - STAT_HEAD_LEN) / (wdth * sizeof(u64));
+
+        nrow = crow < nrow ? crow : nrow;
+    }
+
+    g_stat_nrow = nrow == (u64)-1 ? 0 : nrow;
+
+    for (int i = 0; i < STAT_COL_COUNT; ++i) {
+        u64  wdth = i < STAT_GLOBAL_COUNT ? 1 : CORE_COUNT;
+        long size = (long)(STAT_HEAD_LEN + g_stat_nrow * wdth * sizeof(u64));
+
+        if (ftell(g_stat_files[i]) > size) {
+#ifndef NDEBUG
+            int trnc = ftruncate(fileno(g_stat_files[i]), size);
+#else
+            ftruncate(fileno(g_stat_files[i]), size);
+#endif
+
+            assert(trnc == 0);
+        }
+    }
+
+    salis_stat_commit();
+}
+
+void salis_stat_close() {
+    for (int i = 0; i < STAT_COL_COUNT; ++i) {
+        assert(g_stat_files[i]);
+
+        fclose(g_stat_files[i]);
+
+        g_stat_files[i] = NULL;
+    }
+
+    fclose(g_stat_rows);
+
+    g_stat_rows = NULL;
+}
+
+void salis_stat_reset() {
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        g_cores[i].stps = 0;
+        g_cores[i].stpl = 0;
+        g_cores[i].stns = 0;
+    }
+}
+
+// Appends one row to every column. Rows are flushed right away, so readers
+// may map the files while the simulation runs, trusting only as many rows as
+// the 'rows' file holds.
+void salis_stat_emit() {
+    u64 vals[CORE_COUNT];
+
+#define STAT_COLUMN(name, expr)                                 \
+    vals[0] = expr;                                             \
+    fwrite(vals, sizeof(u64), 1, g_stat_files[STAT_COL_##name]);
+    STAT_GLOBAL_COLUMNS
+#undef STAT_COLUMN
+
+#define STAT_COLUMN(name, expr)                                             \
+    for (int i = 0; i < CORE_COUNT; ++i) {                                  \
+        const Core *core = &g_cores[i];                                     \
+        vals[i] = expr;                                                     \
+    }                                                                       \
+    fwrite(vals, sizeof(u64), CORE_COUNT, g_stat_files[STAT_COL_##name]);
+    STAT_CORE_COLUMNS
+#undef STAT_COLUMN
+
+    for (int i = 0; i < STAT_COL_COUNT; ++i) {
+        fflush(g_stat_files[i]);
+    }
+
+    g_stat_nrow++;
+
+    salis_stat_commit();
+    salis_stat_reset();
+}
+#endif
+
+#if PHASE_TIMING == 1
+const char *g_phsc_names[] = {
+#define PHASE(name, stck) #name,
+    PHASE_CORE_LIST
+#undef PHASE
+};
+
+const char *g_phsc_stcks[] = {
+#define PHASE(name, stck) stck,
+    PHASE_CORE_LIST
+#undef PHASE
+};
+
+const char *g_phsm_names[] = {
+#define PHASE(name, stck) #name,
+    PHASE_MAIN_LIST
+#undef PHASE
+};
+
+const char *g_phsm_stcks[] = {
+#define PHASE(name, stck) stck,
+    PHASE_MAIN_LIST
+#undef PHASE
+};
+
+// Marks the start of timing, so the counter can be calibrated against the
+// monotonic clock when reporting
+void salis_phase_open() {
+    g_phase_tsc0 = phase_tsc();
+    g_phase_ns0  = salis_clock_ns();
+}
+
+void salis_phase_print_timer(const char *thrd, const char *name, const Phtm *phtm, double cpns) {
+    assert(thrd);
+    assert(name);
+    assert(phtm);
+
+    if (!phtm->cnt) {
+        return;
+    }
+
+    printf(
+        "    %-8s %s %#12lx calls %12.3f ms, mean %#lx cycles\n        histogram:",
+        thrd,
+        name,
+        phtm->cnt,
+        phtm->cycs / cpns / 1e6,
+        phtm->cycs / phtm->cnt
+    );
+
+    for (int i = 0; i < PHASE_HIST_LEN; ++i) {
+        if (phtm->hist[i]) {
+            printf(" 2^%d:%#lx", i, phtm->hist[i]);
+        }
+    }
+
+    putchar('\n');
+}
+
+// Prints every phase timer, along with histograms of occurrence lengths
+void salis_phase_print() {
+    u64    nsec = salis_clock_ns() - g_phase_ns0;
+    double cpns = nsec ? (double)(phase_tsc() - g_phase_tsc0) / nsec : 1.0;
+    char   thrd[0x10];
+
+    printf("phase timings (%.3f cycles per ns):\n", cpns);
+
+    for (int i = 0; i < PHSM_COUNT; ++i) {
+        salis_phase_print_timer("main", g_phsm_names[i], &g_phtm[i], cpns);
+    }
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        snprintf(thrd, sizeof(thrd), "core %d", i);
+
+        for (int j = 0; j < PHSC_COUNT; ++j) {
+            salis_phase_print_timer(thrd, g_phsc_names[j], &g_cores[i].phtm[j], cpns);
+        }
+    }
+}
+
+// Writes total cycles of every phase as folded stacks, one root per thread
+void salis_phase_close() {
+    FILE *f = fopen(PHASE_PATH, "w");
+
+    assert(f);
+
+    for (int i = 0; i < PHSM_COUNT; ++i) {
+        if (g_phtm[i].cycs) {
+            fprintf(f, "main;%s %lu\n", g_phsm_stcks[i], g_phtm[i].cycs);
+        }
+    }
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        for (int j = 0; j < PHSC_COUNT; ++j) {
+            if (g_cores[i].phtm[j].cycs) {
+                fprintf(f, "core_%d;%s %lu\n", i, g_phsc_stcks[j], g_cores[i].phtm[j].cycs);
+            }
+        }
+    }
+
+    fclose(f);
+}
+#endif
+
+#if OPCODE_STATS == 1
+// Cores count into their own arrays while stepping, which get merged into
+// the totals at every sync, or whenever totals are read while cores are idle
+void salis_opcs_merge() {
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        Core *core = &g_cores[i];
+
+        for (int j = 0; j < INST_CAPS; ++j) {
+            g_opcs_inst[i][j] += core->opci[j];
+        }
+
+        for (int j = 0; j < OPEV_COUNT; ++j) {
+            g_opcs_evnt[i][j] += core->opce[j];
+        }
+
+        memset(core->opci, 0, sizeof(core->opci));
+        memset(core->opce, 0, sizeof(core->opce));
+    }
+}
+
+#if REWIND_RING > 0
+// Drops counts since the last merge, as replayed steps were counted already
+void salis_opcs_reset() {
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        memset(g_cores[i].opci, 0, sizeof(g_cores[i].opci));
+        memset(g_cores[i].opce, 0, sizeof(g_cores[i].opce));
+    }
+}
+#endif
+
+// Prints totals of all cores, skipping opcodes never executed
+void salis_opcs_print() {
+    const char *enms[OPEV_COUNT] = { "failed seeks", "failed allocs", "blocked writes" };
+
+    u64  inst[INST_CAPS]  = {0};
+    u64  evnt[OPEV_COUNT] = {0};
+    u64  totl             = 0;
+    char mnem[MNEMONIC_BUFF_SIZE];
+
+    salis_opcs_merge();
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        for (int j = 0; j < INST_CAPS; ++j) {
+            inst[j] += g_opcs_inst[i][j];
+            totl    += g_opcs_inst[i][j];
+        }
+
+        for (int j = 0; j < OPEV_COUNT; ++j) {
+            evnt[j] += g_opcs_evnt[i][j];
+        }
+    }
+
+    printf("opcode counts (%#lx instructions):\n", totl);
+
+    for (int i = 0; i < INST_CAPS; ++i) {
+        if (!inst[i]) {
+            continue;
+        }
+
+        arch_mnemonic((u8)i, mnem);
+        printf("    %02x %-16s %#18lx %6.2f%%\n", i, mnem, inst[i], inst[i] * 100.0 / totl);
+    }
+
+    for (int i = 0; i < OPEV_COUNT; ++i) {
+        printf("    %-19s %#18lx\n", enms[i], evnt[i]);
+    }
+}
+#endif
+
+#if ACTION == ACT_LOAD || ACTION == ACT_NEW
+u64 salis_raw_size(const Core *cores) {
+    assert(cores);
+
+    u64 size = SAVE_HEAD_LEN;
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        size += core_raw_size(&cores[i]);
+    }
+
+    return size;
+}
+
+void salis_iost_print(const char *label, const Iost *iost) {
+    assert(label);
+    assert(iost);
+
+    double secs = iost->time / 1e9;
+
+    printf(
+        "%s: %#lx bytes raw, %#lx bytes on disk (%.2fx) in %.3f s (%.1f MiB/s raw)\n",
+        label,
+        iost->rsiz,
+        iost->psiz,
+        iost->psiz ? (double)iost->rsiz / iost->psiz : 0.,
+        secs,
+        secs > 0. ? iost->rsiz / secs / 0x100000 : 0.
+    );
+}
+
+void salis_iost_init() {
+    // save statistics get written by the background writer processes
+    g_iost_save = mmap(NULL, sizeof(Iost), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    assert(g_iost_save != MAP_FAILED);
+}
+
+void salis_head_fill(Head *head, u64 kind) {
+    assert(head);
+    assert(strlen(ARCHITECTURE) < SAVE_NAME_LEN);
+
+    memset(head, 0, sizeof(Head));
+    memcpy(head->magc, SAVE_MAGIC, sizeof(head->magc));
+    strcpy(head->arch, ARCHITECTURE);
+
+    head->vers = SAVE_VERSION;
+    head->kind = kind;
+    head->ccnt = CORE_COUNT;
+    head->mvsz = MVEC_SIZE;
+    head->sync = SYNC_INTERVAL;
+    head->psiz = sizeof(Proc);
+    head->pfnm = SAVE_FELD_CNT;
+    head->step = g_steps;
+    head->sncs = g_syncs;
+    head->hsiz = SAVE_HEAD_LEN;
+
+#if DELTA_BASE > 1
+    head->prnt = kind == SAVE_KIND_DELT ? g_delt_prnt : 0;
+#endif
+}
+
+void salis_write_core(FILE *f, Pack *pack, u64 kind) {
+    assert(f);
+    assert(pack);
+    assert(pack->core);
+
+    switch (kind) {
+    case SAVE_KIND_FULL:
+        core_save(f, pack->core);
+        break;
+    case SAVE_KIND_PACK:
+        core_save_live(f, pack->core);
+        fwrite(pack->data, sizeof(u8), pack->size, f);
+        free(pack->data);
+        break;
+#if DELTA_BASE > 1
+    case SAVE_KIND_DELT:
+        core_save_delta(f, pack->core);
+        break;
+#endif
+    default:
+        assert(false);
+    }
+}
+
+// Returns false if the save could not be written, leaving any previous save
+// at 'path' untouched.
+bool salis_write(const char *path, bool delta) {
+    assert(path);
+#if DELTA_BASE <= 1
+    assert(!delta);
+#endif
+
+    // write into a temporary file first, so that a crash (or a concurrent
+    // load) never observes a partially written save
+    char tpath[AUTO_SAVE_NAME_LEN + sizeof(SAVE_TEMP_EXTN)];
+
+#ifndef NDEBUG
+    int rem = snprintf(
+#else
+    snprintf(
+#endif
+        tpath,
+        sizeof(tpath),
+        "%s%s",
+        path,
+        SAVE_TEMP_EXTN
+    );
+
+    assert(rem >= 0);
+    assert(rem < (int)sizeof(tpath));
+
+    u64   beg  = salis_clock_ns();
+    u64   kind = delta ? SAVE_KIND_DELT : SAVE_COMPRESS ? SAVE_KIND_PACK : SAVE_KIND_FULL;
+    FILE *f    = fopen(tpath, "wb");
+    char *buff = aligned_alloc(SAVE_BUFF_ALGN, SAVE_BUFF_SIZE);
+
+    assert(buff);
+
+    if (!f) {
+        free(buff);
+        return false;
+    }
+
+    setvbuf(f, buff, _IOFBF, SAVE_BUFF_SIZE);
+
+    // checksums (and compression, if enabled) are computed in parallel
+    Pack pack[CORE_COUNT];
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        pack[i].core = &g_cores[i];
+        pack[i].cmpr = kind == SAVE_KIND_PACK;
+
+#if SAVE_COMPRESS == 1
+        thrd_create(&pack[i].thread, (thrd_start_t)core_pack, &pack[i]);
+#else
+        thrd_create(&pack[i].thread, (thrd_start_t)core_csum_job, &pack[i]);
+#endif
+    }
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        thrd_join(pack[i].thread, NULL);
+    }
+
+    Head head;
+    Hsec secs[CORE_COUNT];
+
+    salis_head_fill(&head, kind);
+
+    fwrite(&head,       sizeof(Head), 1,             f);
+    fwrite(g_save_flds, sizeof(Hfld), SAVE_FELD_CNT, f);
+    fwrite(secs,        sizeof(Hsec), CORE_COUNT,    f);
+    core_sect_align(f);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        secs[i].offs = (u64)ftell(f);
+        salis_write_core(f, &pack[i], kind);
+        secs[i].size = (u64)ftell(f) - secs[i].offs;
+        secs[i].csum = pack[i].csum;
+    }
+
+    u64 psiz = (u64)ftell(f);
+
+    // section table gets filled in once all sections are written
+    bool fail = fseek(f, sizeof(Head) + sizeof(g_save_flds), SEEK_SET) != 0;
+
+    fwrite(secs, sizeof(Hsec), CORE_COUNT, f);
+
+    // a full disk must not replace a good save with a truncated one
+    fail |= ferror(f) != 0;
+    fail |= fclose(f) != 0;
+
+    free(buff);
+
+    if (fail || rename(tpath, path)) {
+        unlink(tpath);
+        return false;
+    }
+
+    if (g_iost_save) {
+        g_iost_save->rsiz = salis_raw_size(g_cores);
+        g_iost_save->psiz = psiz;
+        g_iost_save->time = salis_clock_ns() - beg;
+        g_iost_save->count++;
+    }
+
+    return true;
+}
+
+void salis_save(const char *path) {
+    assert(path);
+
+    if (!salis_write(path, false)) {
+        fprintf(stderr, "cannot save '%s'\n", path);
+    }
+}
+
+// Reports failed saves, in optimized builds too
+void salis_save_fail(const char *path) {
+    assert(path);
+
+    fprintf(stderr, "cannot save '%s', previous save kept\n", path);
+
+#if DELTA_BASE > 1
+    // later deltas would lack their parent, so the next save is a full one
+    g_delt_live = false;
+#endif
+}
+
+void salis_save_status(int status) {
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        salis_save_fail(g_asav_path);
+    }
+}
+
+void salis_save_wait() {
+    if (!g_asav_pid) {
+        return;
+    }
+
+    int status = 0;
+
+#ifndef NDEBUG
+    pid_t pid = waitpid(g_asav_pid, &status, 0);
+#else
+    waitpid(g_asav_pid, &status, 0);
+#endif
+
+    assert(pid == g_asav_pid);
+
+    salis_save_status(status);
+
+    g_asav_pid = 0;
+}
+
+void salis_save_poll() {
+    if (!g_asav_pid) {
+        return;
+    }
+
+    int status = 0;
+
+    if (waitpid(g_asav_pid, &status, WNOHANG) == g_asav_pid) {
+        salis_save_status(status);
+        g_asav_pid = 0;
+    }
+}
+
+/*
+ * Saves are written from a forked child process, which gets a copy-on-write
+ * snapshot of the whole simulation for free. The simulation only blocks for
+ * the duration of the fork (plus waiting on a still running previous save).
+ *
+ * UIs may have other threads running across the fork (log drains, frame
+ * writers, the daemon's control socket), while the child still calls malloc,
+ * stdio and thrd_create, which POSIX leaves undefined after forking a
+ * multithreaded process. This assumes glibc, which holds its malloc and stdio
+ * locks across fork, so the child never inherits them taken. With other C
+ * libraries, or when fork fails (e.g. large worlds under strict overcommit),
+ * saves get written synchronously instead. Returns false if such a save
+ * failed.
+ */
+bool salis_save_async(const char *path, bool delta) {
+    assert(path);
+    assert(strlen(path) < AUTO_SAVE_NAME_LEN);
+
+    u64 beg = salis_clock_ns();
+
+    salis_save_wait();
+
+#ifdef __GLIBC__
+    pid_t pid = fork();
+#else
+    pid_t pid = -1;
+#endif
+
+    if (pid == 0) {
+        _exit(salis_write(path, delta) ? 0 : 1);
+    }
+
+    strcpy(g_asav_path, path);
+
+    if (pid == -1 && !salis_write(path, delta)) {
+        salis_save_fail(path);
+        return false;
+    }
+
+    g_asav_pid          = pid == -1 ? 0 : pid;
+    g_asav_block        = salis_clock_ns() - beg;
+    g_asav_block_total += g_asav_block;
+    g_asav_count++;
+
+    return true;
+}
+
+void salis_auto_save() {
+    salis_save_poll();
+
+    if (g_steps % AUTO_SAVE_INTERVAL != 0) {
+        return;
+    }
+
+    // a delta can only be written when its parent checkpoint was taken in
+    // this session, as dirty pages are not tracked across loads, and was
+    // written successfully
+#if DELTA_BASE > 1
+    salis_save_wait();
+
+    bool delta = g_delt_live && (g_steps / AUTO_SAVE_INTERVAL) % DELTA_BASE != 0;
+#else
+    bool delta = false;
+#endif
+
+#ifndef NDEBUG
+    int rem = snprintf(
+#else
+    snprintf(
+#endif
+        g_asav_pbuf,
+        AUTO_SAVE_NAME_LEN,
+        "%s-%#018lx%s",
+        SIM_PATH,
+        g_steps,
+        delta ? SAVE_DELT_EXTN : ""
+    );
+
+    assert(rem >= 0);
+    assert(rem < AUTO_SAVE_NAME_LEN);
+
+    if (!salis_save_async(g_asav_pbuf, delta)) {
+        return;
+    }
+
+#if DELTA_BASE > 1
+    // the writer process keeps its own copy of the dirty page maps
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        memset(g_cores[i].mdrt, 0, MVEC_PAGE_CNT);
+    }
+
+    g_delt_live = true;
+    g_delt_prnt = g_steps;
+#endif
+}
+#endif
+
+#if REWIND_RING > 0
+/*
+ * The rewind ring keeps the last REWIND_RING checkpoints in memory, taken
+ * every REWIND_SYNCS syncs. Each core is serialized on its own thread, in
+ * the same format as compressed saves, so a checkpoint typically takes a
+ * small fraction of the world's live size. Since the simulation is
+ * deterministic, any step after the oldest checkpoint can be reached again
+ * by restoring the nearest one and stepping forward.
+ */
+int core_ckpt_save(Pack *pack) {
+    assert(pack);
+    assert(pack->core);
+    assert(!pack->data);
+
+    char  *data = NULL;
+    size_t size = 0;
+    FILE  *f    = open_memstream(&data, &size);
+    u8    *buff = malloc(codec_bound(MVEC_SIZE));
+
+    assert(f);
+    assert(buff);
+
+    u64 csiz = codec_pack(pack->core->mvec, MVEC_SIZE, buff);
+
+    core_save_live(f, pack->core);
+    fwrite(&csiz, sizeof(u64), 1, f);
+    fwrite(buff, sizeof(u8), csiz, f);
+    fclose(f);
+    free(buff);
+
+    pack->data = (u8 *)data;
+    pack->size = size;
+
+    return 0;
+}
+
+int core_ckpt_load(Pack *pack) {
+    assert(pack);
+    assert(pack->core);
+    assert(pack->data);
+
+    Pack  unpk = { .core = pack->core };
+    FILE *f    = fmemopen(pack->data, pack->size, "rb");
+
+    assert(f);
+
+    // checkpoints never leave memory, so they can't get corrupted
+#ifndef NDEBUG
+    bool okay = core_load_packed(f, &unpk);
+#else
+    core_load_packed(f, &unpk);
+#endif
+
+    assert(okay);
+
+    fclose(f);
+
+#ifndef NDEBUG
+    int res = core_unpack(&unpk);
+#else
+    core_unpack(&unpk);
+#endif
+
+    assert(res == 0);
+
+    return 0;
+}
+
+void salis_rewind_take() {
+    // replaying past steps finds their checkpoints already in the ring
+    for (int i = 0; i < REWIND_RING; ++i) {
+        if (g_ckpt_ring[i].pack[0].data && g_ckpt_ring[i].step == g_steps) {
+            return;
+        }
+    }
+
+    Ckpt *ckpt = &g_ckpt_ring[g_ckpt_next++ % REWIND_RING];
+
+    ckpt->step = g_steps;
+    ckpt->sncs = g_syncs;
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        free(ckpt->pack[i].data);
+
+        ckpt->pack[i].core = &g_cores[i];
+        ckpt->pack[i].data = NULL;
+
+        thrd_create(&ckpt->pack[i].thread, (thrd_start_t)core_ckpt_save, &ckpt->pack[i]);
+    }
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        thrd_join(ckpt->pack[i].thread, NULL);
+    }
+}
+
+// Returns the step of the oldest checkpoint in the ring.
+u64 salis_rewind_oldest() {
+    u64 step = g_steps;
+
+    for (int i = 0; i < REWIND_RING; ++i) {
+        if (g_ckpt_ring[i].pack[0].data && g_ckpt_ring[i].step < step) {
+            step = g_ckpt_ring[i].step;
+        }
+    }
+
+    return step;
+}
+
+u64 salis_rewind_size() {
+    u64 size = 0;
+
+    for (int i = 0; i < REWIND_RING; ++i) {
+        for (int j = 0; j < CORE_COUNT; ++j) {
+            size += g_ckpt_ring[i].pack[j].size;
+        }
+    }
+
+    return size;
+}
+#endif
+
+const char *g_mems_names[] = {
+    "core",
+    "pvec",
+#if PHYLO_LOG == 1
+    "pbst",
+#endif
+#if GENOME_CENSUS == 1
+    "cens",
+#endif
+    "ipcm",
+};
+
+// Bytes of the page aligned range at 'addr' currently backed by RAM
+u64 salis_mems_resident(const void *addr, u64 size) {
+    assert(addr);
+
+    u64 pgsz = (u64)sysconf(_SC_PAGESIZE);
+    u64 pcnt = (size + pgsz - 1) / pgsz;
+    u64 resd = 0;
+    u8 *pvec = malloc(pcnt);
+
+    assert(pvec);
+
+    if (!mincore((void *)addr, size, pvec)) {
+        for (u64 i = 0; i < pcnt; ++i) {
+            resd += pvec[i] & 1;
+        }
+    }
+
+    free(pvec);
+
+    return resd * pgsz < size ? resd * pgsz : size;
+}
+
+// Adds resident and reserved bytes of every subsystem of 'core'. Cores map
+// their memory vectors lazily (from anonymous memory or from save files), so
+// residency of core structs is queried from the kernel. Other buffers get
+// zero filled on allocation, so process vectors are counted resident up to
+// their live processes only.
+void salis_mems_core(const Core *core, u64 *resd, u64 *rsrv) {
+    assert(core);
+    assert(resd);
+    assert(rsrv);
+
+    resd[MEMS_CORE] += salis_mems_resident(core, sizeof(Core));
+    rsrv[MEMS_CORE] += sizeof(Core);
+    resd[MEMS_PVEC] += core->pnum * sizeof(Proc);
+    rsrv[MEMS_PVEC] += core->pcap * sizeof(Proc);
+#if PHYLO_LOG == 1
+    resd[MEMS_PBST] += core->pnum * sizeof(u64);
+    rsrv[MEMS_PBST] += core->pcap * sizeof(u64);
+#endif
+#if GENOME_CENSUS == 1
+    const Cens *cens = &core->cens;
+
+    resd[MEMS_CENS] += core->pnum * sizeof(u64) + cens->gnum * (sizeof(Cgen) + sizeof(u64)) + cens->asiz;
+    rsrv[MEMS_CENS] += core->pcap * sizeof(u64) + cens->gcap * (sizeof(Cgen) + sizeof(u64)) + cens->acap;
+    rsrv[MEMS_CENS] += cens->hcap * sizeof(u64) + cens->fcap * sizeof(u64) + cens->gbsz;
+#endif
+    resd[MEMS_IPCM] += SYNC_INTERVAL * (sizeof(u8) + sizeof(u64));
+    rsrv[MEMS_IPCM] += SYNC_INTERVAL * (sizeof(u8) + sizeof(u64));
+}
+
+// Resident set size of the whole process, as reported by the kernel
+u64 salis_mems_rss() {
+    FILE *f    = fopen("/proc/self/statm", "r");
+    u64   size = 0;
+    u64   rss  = 0;
+
+    if (!f) {
+        return 0;
+    }
+
+    if (fscanf(f, "%lu %lu", &size, &rss) != 2) {
+        rss = 0;
+    }
+
+    fclose(f);
+
+    return rss * (u64)sysconf(_SC_PAGESIZE);
+}
+
+// Sums resident and reserved bytes of all cores, plus rewind checkpoints
+void salis_mems_totals(u64 *resd, u64 *rsrv) {
+    assert(resd);
+    assert(rsrv);
+
+    u64 cres[MEMS_COUNT] = {0};
+    u64 crsv[MEMS_COUNT] = {0};
+
+    *resd = 0;
+    *rsrv = 0;
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        salis_mems_core(&g_cores[i], cres, crsv);
+    }
+
+    for (int i = 0; i < MEMS_COUNT; ++i) {
+        *resd += cres[i];
+        *rsrv += crsv[i];
+    }
+
+#if REWIND_RING > 0
+    *resd += salis_rewind_size();
+    *rsrv += salis_rewind_size();
+#endif
+}
+
+// Prints a one line summary, cheap enough to be printed at every step block
+void salis_mems_report() {
+    u64 resd = 0;
+    u64 rsrv = 0;
+    u64 pgrw = 0;
+
+    salis_mems_totals(&resd, &rsrv);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        pgrw += g_cores[i].pgrw;
+    }
+
+    printf(
+        "memory: %.3f MiB resident of %.3f MiB reserved, %#lx process vector growths, %.3f MiB process rss\n",
+        resd / (double)0x100000,
+        rsrv / (double)0x100000,
+        pgrw,
+        salis_mems_rss() / (double)0x100000
+    );
+}
+
+// Prints resident and reserved bytes of every subsystem on every core
+void salis_mems_print() {
+    printf("memory footprint (resident / reserved bytes):\n");
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        const Core *core = &g_cores[i];
+
+        u64 resd[MEMS_COUNT] = {0};
+        u64 rsrv[MEMS_COUNT] = {0};
+
+        salis_mems_core(core, resd, rsrv);
+
+        printf(
+            "    core %-3d pcap %#lx (peak %#lx), peak pnum %#lx, %#lx process vector growths\n",
+            i,
+            core->pcap,
+            core->pcpk,
+            core->pnpk,
+            core->pgrw
+        );
+
+        for (int j = 0; j < MEMS_COUNT; ++j) {
+            printf("        %-6s %#14lx / %#14lx\n", g_mems_names[j], resd[j], rsrv[j]);
+        }
+    }
+
+#if REWIND_RING > 0
+    printf("    rewind      %#14lx\n", salis_rewind_size());
+#endif
+
+    salis_mems_report();
+}
+
+#if GENOME_CENSUS == 1
+// Registers all live processes into fresh censuses, after cores get
+// initialized, loaded or restored from a checkpoint
+void salis_cens_build() {
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        core_cens_build(&g_cores[i]);
+    }
+}
+
+void salis_cens_free() {
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        cens_free(&g_cores[i].cens);
+        free(g_cores[i].pgid);
+
+        g_cores[i].pgid = NULL;
+    }
+}
+
+// Simpson's index of 'cens', the chance of two random processes (drawn with
+// replacement) carrying different genotypes
+double cens_simpson(const Cens *cens) {
+    assert(cens);
+
+    return cens->pnum ? 1.0 - (double)cens->sqrs / ((double)cens->pnum * cens->pnum) : 0.0;
+}
+
+int cens_compare_hash(const void *a, const void *b) {
+    const Cgen *ga = a;
+    const Cgen *gb = b;
+
+    if (ga->hash != gb->hash) {
+        return ga->hash < gb->hash ? -1 : 1;
+    }
+
+    if (ga->size != gb->size) {
+        return ga->size < gb->size ? -1 : 1;
+    }
+
+    return 0;
+}
+
+int cens_compare(const void *a, const void *b) {
+    const Cgen *ga = a;
+    const Cgen *gb = b;
+
+    // most common first, ties broken by hash, as in the genomes tool
+    if (ga->cnt != gb->cnt) {
+        return ga->cnt > gb->cnt ? -1 : 1;
+    }
+
+    if (ga->hash != gb->hash) {
+        return ga->hash < gb->hash ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Merges the live genotypes of all cores into 'gvec', each genotype appearing
+ * once with its counts added up, sorted by descending count. Genotypes only
+ * get compared by hash and size here, which is enough for reporting. Unlike
+ * per core indices, this is linear on the number of live genotypes, so it's
+ * only done on demand. Returns the number of genotypes merged.
+ */
+u64 salis_cens_merge(Cgen **gvec) {
+    assert(gvec);
+
+    u64 gnum = 0;
+    u64 gcap = 0;
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        gcap += g_cores[i].cens.frst[0];
+    }
+
+    *gvec = malloc((gcap ? gcap : 1) * sizeof(Cgen));
+
+    assert(*gvec);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        const Cens *cens = &g_cores[i].cens;
+
+        for (u64 j = 0; j < cens->frst[0]; ++j) {
+            (*gvec)[gnum++] = cens->gvec[cens->rank[j]];
+        }
+    }
+
+    // equal genotypes end up next to each other, with their counts summed
+    // into the first one
+    qsort(*gvec, gnum, sizeof(Cgen), cens_compare_hash);
+
+    u64 merg = 0;
+
+    for (u64 i = 0; i < gnum; ++i) {
+        if (merg && (*gvec)[merg - 1].hash == (*gvec)[i].hash && (*gvec)[merg - 1].size == (*gvec)[i].size) {
+            (*gvec)[merg - 1].cnt += (*gvec)[i].cnt;
+        } else {
+            (*gvec)[merg++] = (*gvec)[i];
+        }
+    }
+
+    qsort(*gvec, merg, sizeof(Cgen), cens_compare);
+
+    return merg;
+}
+
+// Prints a one line summary, cheap enough to be printed at every step block
+void salis_cens_report() {
+    u64 rich = 0;
+    u64 pnum = 0;
+    u64 sqrs = 0;
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        rich += g_cores[i].cens.frst[0];
+        pnum += g_cores[i].cens.pnum;
+        sqrs += g_cores[i].cens.sqrs;
+    }
+
+    // genotypes shared by cores get counted once per core, so world wide
+    // figures are upper bounds, without the cost of merging censuses
+    double simp = pnum ? 1.0 - (double)sqrs / ((double)pnum * pnum) : 0.0;
+
+    printf("census: %#lx processes, up to %#lx genotypes, simpson index up to %.4f\n", pnum, rich, simp);
+}
+
+// Prints diversity indices and the most common genotypes of every core, then
+// of the whole world
+void salis_cens_print() {
+    printf("genotype census (richness, simpson index, inverse simpson index):\n");
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        const Cens *cens = &g_cores[i].cens;
+        double      simp = cens_simpson(cens);
+
+        printf(
+            "    core %-3d %#lx processes, %#lx genotypes (%#lx extinct), simpson %.4f, inverse %.3f\n",
+            i,
+            cens->pnum,
+            cens->frst[0],
+            cens->gnum - cens->frst[0],
+            simp,
+            simp < 1.0 ? 1.0 / (1.0 - simp) : 0.0
+        );
+
+        for (u64 j = 0; j < CENS_TOP && j < cens->frst[0]; ++j) {
+            const Cgen *cgen = &cens->gvec[cens->rank[j]];
+
+            printf("        #%-3lu %#018lx %#10lx instances, %#lx bytes\n", j + 1, cgen->hash, cgen->cnt, cgen->size);
+        }
+    }
+
+    Cgen *gvec = NULL;
+    u64   gnum = salis_cens_merge(&gvec);
+    u64   pnum = 0;
+    u64   sqrs = 0;
+
+    for (u64 i = 0; i < gnum; ++i) {
+        pnum += gvec[i].cnt;
+        sqrs += gvec[i].cnt * gvec[i].cnt;
+    }
+
+    double simp = pnum ? 1.0 - (double)sqrs / ((double)pnum * pnum) : 0.0;
+
+    printf(
+        "    world    %#lx processes, %#lx genotypes, simpson %.4f, inverse %.3f\n",
+        pnum,
+        gnum,
+        simp,
+        simp < 1.0 ? 1.0 / (1.0 - simp) : 0.0
+    );
+
+    for (u64 i = 0; i < CENS_TOP && i < gnum; ++i) {
+        printf("        #%-3lu %#018lx %#10lx instances, %#lx bytes\n", i + 1, gvec[i].hash, gvec[i].cnt, gvec[i].size);
+    }
+
+    free(gvec);
+}
+#endif
+
+#if HEAT_MAPS == 1
+const char *g_heat_names[] = { "exec", "wrte", "cray" };
+
+// Prints event totals of every heatmap, along with its hottest bucket
+void salis_heat_print() {
+    printf(
+        "heatmaps (%#lx buckets of %#lx bytes, sampling one in %#lx fetches and writes):\n",
+        HEAT_BUCKET_CNT,
+        HEAT_BUCKET_SIZE,
+        HEAT_SAMPLE
+    );
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        for (int j = 0; j < HEAT_COUNT; ++j) {
+            const u64 *heat = g_cores[i].heat[j];
+
+            u64 totl = 0;
+            u64 hbix = 0;
+
+            for (u64 k = 0; k < HEAT_BUCKET_CNT; ++k) {
+                totl += heat[k];
+                hbix  = heat[k] > heat[hbix] ? k : hbix;
+            }
+
+            printf(
+                "    core %-3d %s %#18lx samples, hottest at %#lx (%#lx samples)\n",
+                i,
+                g_heat_names[j],
+                totl,
+                hbix << HEAT_BUCKET_POW,
+                heat[hbix]
+            );
+        }
+    }
+}
+
+#if ACTION == ACT_LOAD || ACTION == ACT_NEW
+/*
+ * Writes all heatmaps into a new file under '<NAME>.heat/', named after the
+ * current step. Files have a 64 byte header (`SALISHEA` magic, version, core
+ * count, map count, bucket count, bucket size, sampling period and step)
+ * followed by 64 bit counters, laid out by core, then map, then bucket. Maps
+ * count events since the simulator was started, as they don't get saved.
+ */
+void salis_heat_write() {
+    char path[AUTO_SAVE_NAME_LEN];
+
+    mkdir(SIM_PATH HEAT_EXTN, 0755);
+    snprintf(path, AUTO_SAVE_NAME_LEN, "%s/%#018lx%s", SIM_PATH HEAT_EXTN, g_steps, HEAT_EXTN);
+
+    FILE *f = fopen(path, "wb");
+
+    assert(f);
+
+    u64 head[7] = {
+        HEAT_VERSION,
+        CORE_COUNT,
+        HEAT_COUNT,
+        HEAT_BUCKET_CNT,
+        HEAT_BUCKET_SIZE,
+        HEAT_SAMPLE,
+        g_steps,
+    };
+
+    fwrite(HEAT_MAGIC, sizeof(char), 8, f);
+    fwrite(head, sizeof(u64), 7, f);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        fwrite(g_cores[i].heat, sizeof(u64), HEAT_COUNT * HEAT_BUCKET_CNT, f);
+    }
+
+    fclose(f);
+}
+#endif
+#endif
+
+#if ACTION == ACT_BENCH || ACTION == ACT_NEW
+void salis_init() {
+    for (int i = 0; i < 0x100; ++i) {
+        arch_mnemonic(i, g_mnemo_table[i]);
+    }
+
+    u64   seed       = SEED;
+    char  anc_list[] = ANC_LIST;
+
+    assert(anc_list);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        core_init(i, &seed, strtok(i ? NULL : anc_list, ","));
+    }
+
+#if GENOME_CENSUS == 1
+    salis_cens_build();
+#endif
+
+#if PHASE_TIMING == 1
+    salis_phase_open();
+#endif
+
+#if STATE_DIGEST == 1
+    salis_digest_open();
+#endif
+
+#if EVENT_LOG == 1
+    salis_evnt_open();
+#endif
+
+#if PHYLO_LOG == 1
+    salis_phyl_open();
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        for (u64 pix = g_cores[i].pfst; pix <= g_cores[i].plst; ++pix) {
+            core_phyl(&g_cores[i], PHYL_BORN, pix, PHYL_NONE, 0, 0);
+        }
+    }
+#endif
+
+#if STATS_LOG == 1
+    salis_stat_open();
+#endif
+
+#if ACTION == ACT_NEW
+    salis_iost_init();
+    salis_auto_save();
 #endif
 
-    arch_anc_init(core, anc_size);
+#if REWIND_RING > 0
+    salis_rewind_take();
+#endif
 }
 #endif
 
 #if ACTION == ACT_LOAD
-void core_load(FILE *f, Core *core) {
-    assert(f);
-    assert(core);
+void salis_load_check(bool cond, const char *path, const char *what) {
+    assert(path);
+    assert(what);
+
+    // saves are user input, so these checks are kept in optimized builds
+    if (!cond) {
+        fprintf(stderr, "cannot load '%s': %s\n", path, what);
+        exit(EXIT_FAILURE);
+    }
+}
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-result"
-    fread(&core->mall, sizeof(u64), 1, f);
-    fread( core->muta, sizeof(u64), 4, f);
-    fread(&core->pnum, sizeof(u64), 1, f);
-    fread(&core->pcap, sizeof(u64), 1, f);
-    fread(&core->pfst, sizeof(u64), 1, f);
-    fread(&core->plst, sizeof(u64), 1, f);
-    fread(&core->pcur, sizeof(u64), 1, f);
-    fread(&core->psli, sizeof(u64), 1, f);
-    fread(&core->ncyc, sizeof(u64), 1, f);
-    fread(&core->ivpt, sizeof(u64), 1, f);
-#pragma GCC diagnostic pop
+void salis_load_head(FILE *f, const char *path, Head *head, Hsec *secs) {
+    assert(f);
+    assert(path);
+    assert(head);
+    assert(secs);
 
-    core->iviv = calloc(SYNC_INTERVAL, sizeof(u8));
-    core->ivav = calloc(SYNC_INTERVAL, sizeof(u64));
-    core->pvec = calloc(core->pcap, sizeof(Proc));
+    Hfld flds[SAVE_FELD_CNT] = {0};
 
-    assert(core->iviv);
-    assert(core->ivav);
-    assert(core->pvec);
+    memset(head, 0, sizeof(Head));
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-result"
-    fread(core->iviv, sizeof(u8),   SYNC_INTERVAL, f);
-    fread(core->ivav, sizeof(u64),  SYNC_INTERVAL, f);
-    fread(core->pvec, sizeof(Proc), core->pcap,    f);
-    fread(core->mvec, sizeof(u8),   MVEC_SIZE,     f);
-#pragma GCC diagnostic pop
-}
-#endif
+    salis_load_check(fread(head, sizeof(Head), 1, f) == 1, path, "truncated header");
+    salis_load_check(!memcmp(head->magc, SAVE_MAGIC, sizeof(head->magc)), path, "not a save file");
+    salis_load_check(head->vers == SAVE_VERSION, path, "unsupported save version");
+    salis_load_check(head->kind <= SAVE_KIND_DELT, path, "unknown save kind");
+    salis_load_check(!strncmp(head->arch, ARCHITECTURE, SAVE_NAME_LEN), path, "architecture mismatch");
+    salis_load_check(head->ccnt == CORE_COUNT, path, "core count mismatch");
+    salis_load_check(head->mvsz == MVEC_SIZE, path, "memory vector size mismatch");
+    salis_load_check(head->sync == SYNC_INTERVAL, path, "sync interval mismatch");
+    salis_load_check(head->psiz == sizeof(Proc), path, "process size mismatch");
+    salis_load_check(head->pfnm == SAVE_FELD_CNT, path, "process field count mismatch");
+    salis_load_check(head->hsiz == SAVE_HEAD_LEN, path, "header size mismatch");
+    salis_load_check(head->kind != SAVE_KIND_DELT || head->prnt < head->step, path, "invalid delta parent");
 
-void core_pull_ipcm(Core *core) {
-    assert(core);
-    assert(core->ivpt < SYNC_INTERVAL);
+    salis_load_check(fread(flds, sizeof(Hfld), SAVE_FELD_CNT, f) == SAVE_FELD_CNT, path, "truncated header");
+    salis_load_check(fread(secs, sizeof(Hsec), CORE_COUNT, f) == CORE_COUNT, path, "truncated header");
 
-    u8  *iinst = &core->iviv[core->ivpt];
-    u64 *iaddr = &core->ivav[core->ivpt];
+    for (u64 i = 0; i < SAVE_FELD_CNT; ++i) {
+        bool same = !strncmp(flds[i].name, g_save_flds[i].name, SAVE_FELD_LEN);
 
-    if ((*iinst & IPCM_FLAG) != 0) {
-        mvec_set_inst(core, *iaddr, *iinst & INST_MASK);
+        same = same && flds[i].offs == g_save_flds[i].offs;
+        same = same && flds[i].size == g_save_flds[i].size;
 
-        *iinst = 0;
-        *iaddr = 0;
+        salis_load_check(same, path, "process field layout mismatch");
     }
-
-    assert(*iinst == 0);
-    assert(*iaddr == 0);
 }
 
-void core_push_ipcm(Core *core, u8 inst, u64 addr) {
-    assert(core);
-    assert(core->ivpt < SYNC_INTERVAL);
-    assert((inst & IPCM_FLAG) == 0);
-
-    u8  *iinst = &core->iviv[core->ivpt];
-    u64 *iaddr = &core->ivav[core->ivpt];
+void salis_load_checkpoint(const char *prfx, u64 step, Core *cores);
 
-    assert(*iinst == 0);
-    assert(*iaddr == 0);
+// Loads the save at 'path' into 'cores'. Checkpoints referenced by deltas are
+// looked up next to the simulation at 'prfx'.
+void salis_load_file(const char *prfx, const char *path, Core *cores) {
+    assert(prfx);
+    assert(path);
+    assert(cores);
 
-    *iinst = inst | IPCM_FLAG;
-    *iaddr = addr;
-}
+    FILE *f = fopen(path, "rb");
+    Head  head;
+    Hsec  secs[CORE_COUNT];
 
-void core_step(Core *core) {
-    assert(core);
+    struct stat st;
 
-    if (core->psli != 0) {
-        core_pull_ipcm(core);
-        arch_proc_step(core, core->pcur);
+    salis_load_check(f, path, "file not found");
+    salis_load_check(!fstat(fileno(f), &st), path, "cannot stat file");
+    salis_load_head(f, path, &head, secs);
 
-        core->psli--;
-        core->ivpt++;
+    // truncated saves must be caught before any section gets parsed
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        bool fits = secs[i].offs <= (u64)st.st_size && secs[i].size <= (u64)st.st_size - secs[i].offs;
 
-        return;
+        salis_load_check(fits, path, "core section past end of file");
     }
 
-    if (core->pcur != core->plst) {
-        core->psli = arch_proc_slice(core, ++core->pcur);
-        core_step(core);
-        return;
+    if (head.kind == SAVE_KIND_DELT) {
+        // deltas are replayed on top of their parent checkpoint, whose load
+        // time is accounted for by the recursive call
+        salis_load_checkpoint(prfx, head.prnt, cores);
     }
 
-    core->pcur = core->pfst;
-    core->psli = arch_proc_slice(core, core->pcur);
-    core->ncyc++;
+    u64  beg = salis_clock_ns();
+    Pack pack[CORE_COUNT];
 
-    while (core->mall > MVEC_SIZE / 2 && core->pnum > 1) {
-        proc_kill(core);
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        pack[i].core = &cores[i];
+
+        bool okay = false;
+
+        // core sections are seekable, as the header records their offsets
+        salis_load_check(!fseek(f, (long)secs[i].offs, SEEK_SET), path, "corrupt core section");
+
+        switch (head.kind) {
+        case SAVE_KIND_FULL:
+            okay = core_load(f, &cores[i]);
+            break;
+        case SAVE_KIND_PACK:
+            okay = core_load_packed(f, &pack[i]);
+            break;
+        case SAVE_KIND_DELT:
+#if DELTA_BASE > 1
+            okay = core_load_delta(f, &cores[i]);
+#else
+            salis_load_check(false, path, "delta saves are not supported by this build");
+#endif
+            break;
+        }
+
+        salis_load_check(okay, path, "corrupt core section");
+        salis_load_check((u64)ftell(f) == secs[i].offs + secs[i].size, path, "corrupt core section");
+
+        g_load_csum[i] = secs[i].csum;
     }
 
-    muta_cosmic_ray(core);
-    core_step(core);
-}
+    if (head.kind == SAVE_KIND_PACK) {
+        for (int i = 0; i < CORE_COUNT; ++i) {
+            thrd_create(&pack[i].thread, (thrd_start_t)core_unpack, &pack[i]);
+        }
 
-#if ACTION == ACT_LOAD || ACTION == ACT_NEW
-void salis_save(const char *path) {
-    FILE *f = fopen(path, "wb");
+        // checksums are only verified later, so corrupt streams are caught
+        // here, before they get a chance to spill past the memory vector
+        int fail = 0;
 
-    assert(f);
+        for (int i = 0; i < CORE_COUNT; ++i) {
+            int res = 0;
 
-    for (int i = 0; i < CORE_COUNT; ++i) {
-        core_save(f, &g_cores[i]);
+            thrd_join(pack[i].thread, &res);
+
+            fail |= res;
+        }
+
+        salis_load_check(!fail, path, "corrupt compressed section");
     }
 
-    fwrite(&g_steps, sizeof(u64), 1, f);
-    fwrite(&g_syncs, sizeof(u64), 1, f);
+    g_steps = head.step;
+    g_syncs = head.sncs;
+
+    g_iost_load.rsiz  = salis_raw_size(cores);
+    g_iost_load.psiz += secs[CORE_COUNT - 1].offs + secs[CORE_COUNT - 1].size;
+    g_iost_load.time += salis_clock_ns() - beg;
+    g_iost_load.count++;
+
     fclose(f);
 }
 
-void salis_auto_save() {
-    if (g_steps % AUTO_SAVE_INTERVAL != 0) {
-        return;
-    }
+/*
+ * Reconstructs the checkpoint taken at the given step. Full checkpoints are
+ * loaded directly. Deltas first reconstruct their parent checkpoint
+ * (recursively, down to the nearest full base) and are replayed on top.
+ */
+void salis_load_checkpoint(const char *prfx, u64 step, Core *cores) {
+    assert(prfx);
+    assert(cores);
 
-#ifndef NDEBUG
-    int rem = snprintf(
-#else
-    snprintf(
-#endif
-        g_asav_pbuf,
-        AUTO_SAVE_NAME_LEN,
-        "%s-%#018lx",
-        SIM_PATH,
-        g_steps
-    );
+    char path[AUTO_SAVE_NAME_LEN];
 
-    assert(rem >= 0);
-    assert(rem < AUTO_SAVE_NAME_LEN);
+    snprintf(path, AUTO_SAVE_NAME_LEN, "%s-%#018lx", prfx, step);
+
+    if (access(path, F_OK) != 0) {
+        snprintf(path, AUTO_SAVE_NAME_LEN, "%s-%#018lx%s", prfx, step, SAVE_DELT_EXTN);
+    }
 
-    salis_save(g_asav_pbuf);
+    salis_load_file(prfx, path, cores);
+    salis_load_check(g_steps == step, path, "checkpoint step mismatch");
 }
-#endif
 
-#if ACTION == ACT_BENCH || ACTION == ACT_NEW
-void salis_init() {
-    for (int i = 0; i < 0x100; ++i) {
-        arch_mnemonic(i, g_mnemo_table[i]);
-    }
+#if LOAD_QUICK == 0
+// Checksums of the loaded state are verified in parallel, one core per thread.
+void salis_load_verify(const char *path, Core *cores) {
+    assert(path);
+    assert(cores);
 
-    u64   seed       = SEED;
-    char  anc_list[] = ANC_LIST;
+    Pack pack[CORE_COUNT];
 
-    assert(anc_list);
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        pack[i].core = &cores[i];
+        thrd_create(&pack[i].thread, (thrd_start_t)core_csum_job, &pack[i]);
+    }
 
     for (int i = 0; i < CORE_COUNT; ++i) {
-        core_init(i, &seed, strtok(i ? NULL : anc_list, ","));
+        thrd_join(pack[i].thread, NULL);
     }
 
-#if ACTION == ACT_NEW
-    salis_auto_save();
-#endif
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        salis_load_check(pack[i].csum == g_load_csum[i], path, "checksum mismatch");
+    }
 }
 #endif
 
-#if ACTION == ACT_LOAD
 void salis_load() {
-    FILE *f = fopen(SIM_PATH, "rb");
+    // saved sections must fall on page boundaries to be mapped from the file
+    assert(SAVE_SECT_ALGN % sysconf(_SC_PAGESIZE) == 0);
 
-    assert(f);
+    salis_iost_init();
 
-    for (int i = 0; i < CORE_COUNT; ++i) {
-        core_load(f, &g_cores[i]);
-    }
+#ifdef LOAD_STEP
+    salis_load_checkpoint(SIM_PATH, LOAD_STEP, g_cores);
+#else
+    salis_load_file(SIM_PATH, SIM_PATH, g_cores);
+#endif
+
+#if LOAD_QUICK == 0
+    salis_load_verify(SIM_PATH, g_cores);
+#endif
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-result"
-    fread(&g_steps, sizeof(u64), 1, f);
-    fread(&g_syncs, sizeof(u64), 1, f);
-#pragma GCC diagnostic pop
+#if GENOME_CENSUS == 1
+    salis_cens_build();
+#endif
 
-    fclose(f);
+#if PHASE_TIMING == 1
+    salis_phase_open();
+#endif
+
+#if REWIND_RING > 0
+    salis_rewind_take();
+#endif
+
+#if STATE_DIGEST == 1
+    salis_digest_open();
+#endif
+
+#if EVENT_LOG == 1
+    salis_evnt_open();
+#endif
+
+#if PHYLO_LOG == 1
+    salis_phyl_open();
+#endif
+
+#if STATS_LOG == 1
+    salis_stat_open();
+#endif
 }
 #endif
 
 int salis_thread(Core *core) {
     assert(core);
 
+#if PERF_EVENTS == 1
+    int pfds[PRFC_COUNT];
+
+    perf_open(core, pfds);
+#endif
+
+    core->sbar.tbeg = salis_clock_ns();
+
+#if STATS_LOG == 1
+    u64 beg = salis_clock_ns();
+#endif
+
+#if PHASE_TIMING == 1
+    u64 tbeg = phase_tsc();
+    u64 othr = core->phtm[PHSC_reap].cycs + core->phtm[PHSC_cray].cycs;
+#endif
+
     for (u64 i = 0; i < core->tix; ++i) {
         core_step(core);
     }
 
+#if STATS_LOG == 1
+    core->stns += salis_clock_ns() - beg;
+#endif
+
+#if PHASE_TIMING == 1
+    core->phtb  = phase_tsc() - tbeg;
+    othr        = core->phtm[PHSC_reap].cycs + core->phtm[PHSC_cray].cycs - othr;
+
+    phase_add(&core->phtm[PHSC_step], core->phtb > othr ? core->phtb - othr : 0);
+#endif
+
+    core->sbar.tend = salis_clock_ns();
+
+#if PERF_EVENTS == 1
+    perf_close(core, pfds);
+#endif
+
     return 0;
 }
 
 void salis_run_thread(u64 ns) {
+#if PHASE_TIMING == 1
+    u64 beg = phase_tsc();
+#endif
+
     for (int i = 0; i < CORE_COUNT; ++i) {
         g_cores[i].tix = ns;
 
@@ -621,6 +4125,19 @@ void salis_run_thread(u64 ns) {
         thrd_join(g_cores[i].thread, NULL);
     }
 
+    salis_sbar_update();
+
+#if PHASE_TIMING == 1
+    u64 wall = phase_tsc() - beg;
+    u64 busy = 0;
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        busy = g_cores[i].phtb > busy ? g_cores[i].phtb : busy;
+    }
+
+    phase_add(&g_phtm[PHSM_thrd], wall > busy ? wall - busy : 0);
+#endif
+
     g_steps += ns;
 }
 
@@ -636,11 +4153,50 @@ void salis_sync() {
     g_cores[CORE_COUNT - 1].iviv = iviv0;
     g_cores[CORE_COUNT - 1].ivav = ivav0;
 
+#if STATE_DIGEST == 1
+    u64 ivhs0 = g_cores[0].ivhs;
+
+    for (int i = 1; i < CORE_COUNT; ++i) {
+        g_cores[i - 1].ivhs = g_cores[i].ivhs;
+    }
+
+    g_cores[CORE_COUNT - 1].ivhs = ivhs0;
+#endif
+
     for (int i = 0; i < CORE_COUNT; ++i) {
         g_cores[i].ivpt = 0;
     }
 
     g_syncs++;
+
+#if REWIND_RING > 0
+    // replayed syncs were already logged the first time around
+    if (g_rply) {
+#if STATS_LOG == 1
+        salis_stat_reset();
+#endif
+#if OPCODE_STATS == 1
+        salis_opcs_reset();
+#endif
+        return;
+    }
+#endif
+
+#if STATE_DIGEST == 1
+    salis_digest_emit();
+#endif
+
+#if EVENT_LOG == 1
+    evnt_push(CORE_COUNT, EVNT_SYNC, g_steps, g_syncs, 0, 0, 0);
+#endif
+
+#if STATS_LOG == 1
+    salis_stat_emit();
+#endif
+
+#if OPCODE_STATS == 1
+    salis_opcs_merge();
+#endif
 }
 
 void salis_loop(u64 ns, u64 dt) {
@@ -652,9 +4208,33 @@ void salis_loop(u64 ns, u64 dt) {
     }
 
     salis_run_thread(dt);
+#if PHASE_TIMING == 1
+    u64 beg = phase_tsc();
+#endif
     salis_sync();
+#if PHASE_TIMING == 1
+    phase_add(&g_phtm[PHSM_sync], phase_tsc() - beg);
+#endif
 #if ACTION == ACT_LOAD || ACTION == ACT_NEW
+#if PHASE_TIMING == 1
+    beg = phase_tsc();
+#endif
+#if REWIND_RING > 0
+    // replayed saves would overwrite checkpoints already on disk
+    if (!g_rply) {
+        salis_auto_save();
+    }
+#else
     salis_auto_save();
+#endif
+#if PHASE_TIMING == 1
+    phase_add(&g_phtm[PHSM_asav], phase_tsc() - beg);
+#endif
+#endif
+#if REWIND_RING > 0
+    if (g_syncs % REWIND_SYNCS == 0) {
+        salis_rewind_take();
+    }
 #endif
     salis_loop(ns - dt, SYNC_INTERVAL);
 }
@@ -691,6 +4271,33 @@ void salis_validate_core(const Core *core) {
     }
 
     assert(core->ivpt == g_steps % SYNC_INTERVAL);
+
+#if STATE_DIGEST == 1
+    assert(core->mvhs == core_digest_mvec(core));
+    assert(core->ivhs == core_digest_ipcm(core));
+#endif
+
+#if GENOME_CENSUS == 1
+    const Cens *cens = &core->cens;
+
+    u64 pnum = 0;
+    u64 sqrs = 0;
+
+    for (u64 i = 0; i < cens->gnum; ++i) {
+        const Cgen *cgen = &cens->gvec[cens->rank[i]];
+
+        assert(cgen->rank == i);
+        assert(i == 0 || cens->gvec[cens->rank[i - 1]].cnt >= cgen->cnt);
+        assert((cgen->cnt != 0) == (i < cens->frst[0]));
+
+        pnum += cgen->cnt;
+        sqrs += cgen->cnt * cgen->cnt;
+    }
+
+    assert(cens->pnum == core->pnum);
+    assert(cens->pnum == pnum);
+    assert(cens->sqrs == sqrs);
+#endif
 }
 
 void salis_validate() {
@@ -711,7 +4318,90 @@ void salis_step(u64 ns) {
 #endif
 }
 
+#if REWIND_RING > 0
+// Restores the nearest checkpoint at or before the given step and replays
+// forward from it. Returns false if the step precedes all checkpoints.
+bool salis_rewind(u64 step) {
+    Ckpt *ckpt = NULL;
+
+    for (int i = 0; i < REWIND_RING; ++i) {
+        Ckpt *cand = &g_ckpt_ring[i];
+
+        if (cand->pack[0].data && cand->step <= step && (!ckpt || cand->step > ckpt->step)) {
+            ckpt = cand;
+        }
+    }
+
+    if (!ckpt) {
+        return false;
+    }
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        thrd_create(&ckpt->pack[i].thread, (thrd_start_t)core_ckpt_load, &ckpt->pack[i]);
+    }
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        thrd_join(ckpt->pack[i].thread, NULL);
+    }
+
+    g_steps = ckpt->step;
+    g_syncs = ckpt->sncs;
+
+#if GENOME_CENSUS == 1
+    salis_cens_build();
+#endif
+
+#if STATE_DIGEST == 1
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        g_cores[i].mvhs = core_digest_mvec(&g_cores[i]);
+        g_cores[i].ivhs = core_digest_ipcm(&g_cores[i]);
+    }
+#endif
+
+#if DELTA_BASE > 1
+    // dirty page maps don't describe the restored state
+    g_delt_live = false;
+#endif
+
+    // the replay reproduces steps already logged and saved, so sync time
+    // logging, phylogeny records and auto-saves are skipped until the
+    // target step is reached
+    if (step > g_steps) {
+        g_rply = true;
+        salis_step(step - g_steps);
+        g_rply = false;
+
+#if OPCODE_STATS == 1
+        // steps replayed after the last sync were counted already too
+        salis_opcs_reset();
+#endif
+    }
+
+#if EVENT_LOG == 1
+    evnt_push(CORE_COUNT, EVNT_RWND, g_steps, g_syncs, 0, 0, 0);
+#endif
+
+#if PHYLO_LOG == 1
+    salis_phyl_mark();
+#endif
+
+#if STATS_LOG == 1
+    // counts since the last sync don't describe the restored state
+    salis_stat_reset();
+#endif
+
+    return true;
+}
+#endif
+
 void salis_free() {
+#if ACTION == ACT_LOAD || ACTION == ACT_NEW
+    salis_save_wait();
+    munmap(g_iost_save, sizeof(Iost));
+
+    g_iost_save = NULL;
+#endif
+
     for (int i = 0; i < CORE_COUNT; ++i) {
         assert(g_cores[i].pvec);
         assert(g_cores[i].iviv);
@@ -724,7 +4414,48 @@ void salis_free() {
         g_cores[i].pvec = NULL;
         g_cores[i].iviv = NULL;
         g_cores[i].ivav = NULL;
+
+#if PHYLO_LOG == 1
+        free(g_cores[i].pbst);
+
+        g_cores[i].pbst = NULL;
+#endif
+    }
+
+#if GENOME_CENSUS == 1
+    salis_cens_free();
+#endif
+
+#if REWIND_RING > 0
+    for (int i = 0; i < REWIND_RING; ++i) {
+        for (int j = 0; j < CORE_COUNT; ++j) {
+            free(g_ckpt_ring[i].pack[j].data);
+
+            g_ckpt_ring[i].pack[j].data = NULL;
+            g_ckpt_ring[i].pack[j].size = 0;
+        }
     }
+#endif
+
+#if PHASE_TIMING == 1
+    salis_phase_close();
+#endif
+
+#if STATE_DIGEST == 1
+    salis_digest_close();
+#endif
+
+#if EVENT_LOG == 1
+    salis_evnt_close();
+#endif
+
+#if PHYLO_LOG == 1
+    salis_phyl_close();
+#endif
+
+#if STATS_LOG == 1
+    salis_stat_close();
+#endif
 }
 
 #include UI
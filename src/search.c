@@ -0,0 +1,84 @@
+// Project: Salis
+// Author:  Paul Oliver
+// Email:   contact@pauloliver.dev
+
+/*
+ * Searches a saved simulation for an instruction pattern. The save gets
+ * loaded as usual (so memory is mapped from the save file), then all cores
+ * are scanned in parallel through the pattern module. Matches get listed by
+ * core and address, along with the process owning them, if any.
+ */
+
+#if ACTION != ACT_LOAD
+#error Using search tool with unsupported action
+#endif
+
+#include "pattern.c"
+
+Ptrn g_ptrn;
+Pjob g_pjobs[CORE_COUNT];
+
+void print_match(const Core *core, const Pmat *pmat) {
+    assert(core);
+    assert(pmat);
+
+    printf("    %#018lx  ", pmat->addr);
+
+    if (pmat->ownr == PTRN_NONE) {
+        printf("%-20s", "free");
+    } else {
+        printf("proc %#-15lx", pmat->ownr);
+    }
+
+    for (u64 i = 0; i < g_ptrn.size; ++i) {
+        printf(" %02x", mvec_get_inst(core, pmat->addr + i));
+    }
+
+    putchar('\n');
+}
+
+int main() {
+    if (!ptrn_parse(&g_ptrn, SEARCH_PATTERN)) {
+        fprintf(stderr, "invalid pattern '%s'\n", SEARCH_PATTERN);
+        exit(EXIT_FAILURE);
+    }
+
+    u64 beg = salis_clock_ns();
+
+    salis_load();
+
+    u64 lbeg = salis_clock_ns();
+    u64 totl = 0;
+
+    ptrn_search(&g_ptrn, g_cores, g_pjobs, SEARCH_LIMIT);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        totl += g_pjobs[i].totl;
+    }
+
+    printf("simulation '%s' at step %#lx\n", SIM_NAME, g_steps);
+    printf("pattern '%s' (%#lx instructions) found %#lx times, ", SEARCH_PATTERN, g_ptrn.size, totl);
+    printf("loaded in %.3f s, searched in %.3f s\n", (lbeg - beg) / 1e9, (salis_clock_ns() - lbeg) / 1e9);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        const Pjob *pjob = &g_pjobs[i];
+
+        printf("\ncore %d: %#lx matches", i, pjob->totl);
+
+        if (pjob->mnum != pjob->totl) {
+            printf(", first %#lx listed", pjob->mnum);
+        }
+
+        putchar('\n');
+
+        for (u64 j = 0; j < pjob->mnum; ++j) {
+            print_match(&g_cores[i], &pjob->mats[j]);
+        }
+
+        pjob_free(&g_pjobs[i]);
+    }
+
+    salis_free();
+
+    return 0;
+}
@@ -3,7 +3,9 @@
 // Email:   contact@pauloliver.dev
 
 /*
- * Implements a TUI for the Salis simulator using the ncurses library.
+ * Implements a TUI for the Salis simulator using the ncurses library. When
+ * built for inspection, saves are browsed read-only: the simulation can't be
+ * stepped and nothing gets written back on exit.
  */
 
 #include <curses.h>
@@ -14,12 +16,20 @@
 #define PANE_WIDTH       (27)
 #define PROC_FIELD_WIDTH (21)
 #define PROC_PAGE_LINES  (12)
+#define REWIND_BUFF_LEN  (0x20)
+#define SEARCH_BUFF_LEN  (0x80)
+#define SEARCH_LIMIT     (0x1000)  // matches kept per core
 
 enum {
     PAGE_CORE,
     PAGE_PROCESS,
     PAGE_WORLD,
     PAGE_IPC,
+    PAGE_MEMORY,
+    PAGE_SEARCH,
+#if OPCODE_STATS == 1
+    PAGE_OPCODE,
+#endif
     PAGE_COUNT
 };
 
@@ -36,6 +46,11 @@ enum {
     PAIR_SELECTED_MB2,
     PAIR_SELECTED_IP,
     PAIR_SELECTED_SP,
+#if HEAT_MAPS == 1
+    PAIR_HEAT_LOW,
+    PAIR_HEAT_MID,
+    PAIR_HEAT_HIGH,
+#endif
 };
 
 bool     g_exit;
@@ -58,6 +73,13 @@ u64      g_vsiz;
 u64      g_vlin_rng;
 u64      g_vsiz_rng;
 u64      g_ivpt_scroll;
+#if OPCODE_STATS == 1
+u64      g_opcs_scroll;
+#endif
+#if HEAT_MAPS == 1
+int      g_heat_kind;   // heatmap shown on the world page, HEAT_COUNT if none
+u64      g_heat_max;
+#endif
 char    *g_line_buff;
 u64      g_step_block;
 
@@ -69,6 +91,16 @@ const wchar_t *g_zoomed_symbols = (
 );
 
 #include "graphics.c"
+#include "pattern.c"
+
+Ptrn g_srch_ptrn;
+Pjob g_srch_jobs[CORE_COUNT];
+char g_srch_text[SEARCH_BUFF_LEN];
+bool g_srch_done;
+u64  g_srch_step;
+u64  g_srch_scroll;
+
+Gfx g_gfx;
 
 void ui_line_buff_free() {
     if (g_line_buff) {
@@ -145,6 +177,34 @@ void ui_ulx_field(int l, const char *label, u64 value) {
     ui_line(false, l, PAIR_NORMAL, A_NORMAL, "%-4s : %#18lx", label, value);
 }
 
+// Lists sync barrier accounting of all cores, with the selected one
+// highlighted, followed by the selected core's wait time histogram
+void ui_print_core_data() {
+    ui_field(0, PANE_WIDTH, PAIR_NORMAL, A_NORMAL, "%4s : %18s : %18s : %18s", "core", "compute ms", "wait ms", "straggler");
+
+    int l = 1;
+
+    for (int i = 0; i < CORE_COUNT && l < LINES; ++i) {
+        const Sbar *sbar = &g_cores[i].sbar;
+
+        int pair = i == (int)g_core ? PAIR_SELECTED_PROC : PAIR_LIVE_PROC;
+
+        ui_field(l++, PANE_WIDTH, pair, A_NORMAL, "%4d : %18.3f : %18.3f : %#18lx", i, sbar->cmpt / 1e6, sbar->watt / 1e6, sbar->strg);
+    }
+
+    l++;
+
+    ui_field(l++, PANE_WIDTH, PAIR_NORMAL, A_NORMAL, "%4s : %18s", "wait", "count");
+
+    const Sbar *sbar = &g_cores[g_core].sbar;
+
+    for (int i = 0; i < SBAR_HIST_LEN && l < LINES; ++i) {
+        if (sbar->hist[i]) {
+            ui_field(l++, PANE_WIDTH, PAIR_LIVE_PROC, A_NORMAL, "2^%-2d : %#18lx", i, sbar->hist[i]);
+        }
+    }
+}
+
 void ui_print_core(int l) {
     ui_line(false, ++l, PAIR_HEADER, A_BOLD, "CORE [%d]", g_core);
     ui_ulx_field(++l, "mall", g_cores[g_core].mall);
@@ -160,6 +220,11 @@ void ui_print_core(int l) {
     ui_ulx_field(++l, "psli", g_cores[g_core].psli);
     ui_ulx_field(++l, "ncyc", g_cores[g_core].ncyc);
     ui_ulx_field(++l, "ivpt", g_cores[g_core].ivpt);
+    ui_ulx_field(++l, "cmpl", g_cores[g_core].sbar.cmpl);
+    ui_ulx_field(++l, "watl", g_cores[g_core].sbar.watl);
+    ui_ulx_field(++l, "strg", g_cores[g_core].sbar.strg);
+
+    ui_print_core_data();
 }
 
 int ui_proc_pair(u64 pix) {
@@ -333,14 +398,35 @@ void ui_world_resize() {
         g_vlin_rng = g_vlin * g_wrld_zoom;
         g_vsiz_rng = g_vsiz * g_wrld_zoom;
 
-        gfx_resize(g_vsiz);
+        gfx_resize(&g_gfx, g_vsiz);
     }
 }
 
+#if HEAT_MAPS == 1
+// Heat levels split the view's range in thirds, on a logarithmic scale
+int ui_heat_pair(u64 heat) {
+    if (!heat) {
+        return PAIR_FREE_CELL;
+    }
+
+    int hlog = 64 - __builtin_clzl(heat);
+    int mlog = 64 - __builtin_clzl(g_heat_max);
+
+    switch (hlog * 3 / (mlog + 1)) {
+    case 0:
+        return PAIR_HEAT_LOW;
+    case 1:
+        return PAIR_HEAT_MID;
+    default:
+        return PAIR_HEAT_HIGH;
+    }
+}
+#endif
+
 void ui_print_cell(u64 i, u64 r, u64 x, u64 y, u64 a) {
     wchar_t inst_nstr[2] = { L'\0', L'\0' };
     cchar_t cchar        = { 0 };
-    u64     inst_avrg    = g_gfx_inst[i] / g_wrld_zoom;
+    u64     inst_avrg    = g_gfx.inst[i] / g_wrld_zoom;
 
     if (g_wrld_zoom == 1) {
         inst_nstr[0] = arch_symbol((u8)inst_avrg);
@@ -354,17 +440,21 @@ void ui_print_cell(u64 i, u64 r, u64 x, u64 y, u64 a) {
         pair_cell = PAIR_NORMAL;
     } else if (g_wcursor_mode && r == (u64)g_wcursor_x && y == (u64)g_wcursor_y) {
         pair_cell = PAIR_NORMAL;
-    } else if (g_gfx_ipas[i] != 0) {
+#if HEAT_MAPS == 1
+    } else if (g_heat_kind != HEAT_COUNT) {
+        pair_cell = ui_heat_pair(g_gfx.heat[i]);
+#endif
+    } else if (g_gfx.ipas[i] != 0) {
         pair_cell = PAIR_SELECTED_IP;
-    } else if (g_gfx_spas[i] != 0) {
+    } else if (g_gfx.spas[i] != 0) {
         pair_cell = PAIR_SELECTED_SP;
-    } else if (g_gfx_mb0s[i] != 0) {
+    } else if (g_gfx.mb0s[i] != 0) {
         pair_cell = PAIR_SELECTED_MB1;
-    } else if (g_gfx_mb1s[i] != 0) {
+    } else if (g_gfx.mb1s[i] != 0) {
         pair_cell = PAIR_SELECTED_MB2;
-    } else if (g_gfx_mbst[i] != 0) {
+    } else if (g_gfx.mbst[i] != 0) {
         pair_cell = PAIR_MEM_BLOCK_START;
-    } else if (g_gfx_mall[i] != 0) {
+    } else if (g_gfx.mall[i] != 0) {
         pair_cell = PAIR_ALLOC_CELL;
     } else {
         pair_cell = PAIR_FREE_CELL;
@@ -414,10 +504,10 @@ void ui_print_wcursor_bar() {
         g_wcursor_x,
         g_wcursor_y,
         caddr,
-        g_gfx_inst[cpos],
-        g_gfx_inst[cpos] / g_wrld_zoom,
-        g_gfx_mall[cpos],
-        g_gfx_mbst[cpos],
+        g_gfx.inst[cpos],
+        g_gfx.inst[cpos] / g_wrld_zoom,
+        g_gfx.mall[cpos],
+        g_gfx.mbst[cpos],
         cmnem,
         cownr
     );
@@ -433,6 +523,9 @@ void ui_print_world(int l) {
     ui_ulx_field(l++, "pabs", g_proc_selected % g_cores[g_core].pcap);
     ui_ulx_field(l++, "vrng", g_vsiz_rng);
     ui_str_field(l++, "curs", g_wcursor_mode ? "on" : "off");
+#if HEAT_MAPS == 1
+    ui_str_field(l++, "heat", g_heat_kind != HEAT_COUNT ? g_heat_names[g_heat_kind] : "off");
+#endif
 
     l++;
 
@@ -448,7 +541,19 @@ void ui_print_world(int l) {
         return;
     }
 
-    gfx_render(&g_cores[g_core], g_wrld_pos, g_wrld_zoom, g_proc_selected);
+    gfx_render(&g_gfx, &g_cores[g_core], g_wrld_pos, g_wrld_zoom, g_proc_selected);
+
+#if HEAT_MAPS == 1
+    if (g_heat_kind != HEAT_COUNT) {
+        gfx_render_heat(&g_gfx, &g_cores[g_core], g_wrld_pos, g_wrld_zoom, g_heat_kind);
+
+        g_heat_max = 0;
+
+        for (u64 i = 0; i < g_vsiz; ++i) {
+            g_heat_max = g_gfx.heat[i] > g_heat_max ? g_gfx.heat[i] : g_heat_max;
+        }
+    }
+#endif
 
     if (g_wcursor_mode) {
         int xmax = g_vlin - 1;
@@ -525,20 +630,195 @@ void ui_print_ipc(int l) {
     ui_print_ipc_data();
 }
 
+// Lists resident and reserved bytes of the selected core's subsystems,
+// followed by totals of the whole simulator
+void ui_print_memory_data() {
+    ui_field(0, PANE_WIDTH, PAIR_NORMAL, A_NORMAL, "%-6s : %18s : %18s", "subs", "resident", "reserved");
+
+    u64 resd[MEMS_COUNT] = {0};
+    u64 rsrv[MEMS_COUNT] = {0};
+    int l                = 1;
+
+    salis_mems_core(&g_cores[g_core], resd, rsrv);
+
+    for (int i = 0; i < MEMS_COUNT; ++i) {
+        ui_field(l++, PANE_WIDTH, PAIR_LIVE_PROC, A_NORMAL, "%-6s : %#18lx : %#18lx", g_mems_names[i], resd[i], rsrv[i]);
+    }
+
+    u64 tres = 0;
+    u64 trsv = 0;
+    u64 gfxs = gfx_size(&g_gfx);
+
+    salis_mems_totals(&tres, &trsv);
+
+    l++;
+
+    ui_field(l++, PANE_WIDTH, PAIR_NORMAL, A_NORMAL, "%-6s : %#18lx : %#18lx", "cores", tres, trsv);
+    ui_field(l++, PANE_WIDTH, PAIR_NORMAL, A_NORMAL, "%-6s : %#18lx : %#18lx", "gfx", gfxs, gfxs);
+    ui_field(l++, PANE_WIDTH, PAIR_NORMAL, A_NORMAL, "%-6s : %#18lx : %18s", "rss", salis_mems_rss(), "");
+}
+
+void ui_print_memory(int l) {
+    l++;
+
+    const Core *core = &g_cores[g_core];
+
+    ui_line(true, l++, PAIR_HEADER, A_BOLD, "MEMORY [%d]", g_core);
+    ui_ulx_field(l++, "pnum", core->pnum);
+    ui_ulx_field(l++, "pnpk", core->pnpk);
+    ui_ulx_field(l++, "pcap", core->pcap);
+    ui_ulx_field(l++, "pcpk", core->pcpk);
+    ui_ulx_field(l++, "pgrw", core->pgrw);
+
+    ui_print_memory_data();
+}
+
+// Lists the selected core's matches of the last search, from the scrolled
+// one onwards, along with their owners and disassembly
+void ui_print_search_data() {
+    ui_field(0, PANE_WIDTH, PAIR_NORMAL, A_NORMAL, "%18s : %18s : %s", "addr", "owner", "instructions");
+
+    const Core *core = &g_cores[g_core];
+    const Pjob *pjob = &g_srch_jobs[g_core];
+    char        mnem[MNEMONIC_BUFF_SIZE];
+    int         l    = 1;
+
+    for (u64 i = g_srch_scroll; g_srch_done && i < pjob->mnum && l < LINES; ++i) {
+        const Pmat *pmat = &pjob->mats[i];
+        int         col  = PANE_WIDTH + 42;
+        int         pair = pmat->ownr == PTRN_NONE ? PAIR_NORMAL : PAIR_LIVE_PROC;
+
+        move(l, PANE_WIDTH);
+        clrtoeol();
+
+        if (pmat->ownr == PTRN_NONE) {
+            ui_field(l, PANE_WIDTH, pair, A_NORMAL, "%#18lx : %18s :", pmat->addr, "free");
+        } else {
+            ui_field(l, PANE_WIDTH, pair, A_NORMAL, "%#18lx : %#18lx :", pmat->addr, pmat->ownr);
+        }
+
+        for (u64 j = 0; j < g_srch_ptrn.size && col < COLS; ++j) {
+            arch_mnemonic(mvec_get_inst(core, pmat->addr + j), mnem);
+            ui_field(l, col, pair, A_NORMAL, "%s", mnem);
+
+            col += (int)strlen(mnem) + 1;
+        }
+
+        l++;
+    }
+
+    for (; l < LINES; ++l) {
+        move(l, PANE_WIDTH);
+        clrtoeol();
+    }
+}
+
+void ui_print_search(int l) {
+    l++;
+
+    const Pjob *pjob = &g_srch_jobs[g_core];
+    u64         totl = 0;
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        totl += g_srch_jobs[i].totl;
+    }
+
+    ui_line(true, l++, PAIR_HEADER, A_BOLD, "SEARCH [%#lx]", g_srch_scroll);
+
+    if (!g_srch_done) {
+        ui_line(true, l++, PAIR_NORMAL, A_NORMAL, "%s", g_srch_text[0] ? "invalid pattern" : "press '/' to search");
+    } else {
+        ui_line(true, l++, PAIR_NORMAL, A_NORMAL, "%s", g_srch_text);
+        ui_ulx_field(l++, "size", g_srch_ptrn.size);
+        ui_ulx_field(l++, "step", g_srch_step);
+        ui_ulx_field(l++, "totl", totl);
+        ui_ulx_field(l++, "core", pjob->totl);
+        ui_ulx_field(l++, "list", pjob->mnum);
+    }
+
+    ui_print_search_data();
+}
+
+#if OPCODE_STATS == 1
+void ui_print_opcode_data() {
+    ui_field(0, PANE_WIDTH, PAIR_NORMAL, A_NORMAL, "%4s : %-16s : %18s : %7s", "inst", "mnem", "count", "share");
+
+    const u64 *inst = g_opcs_inst[g_core];
+    u64        totl = 0;
+    char       mnem[MNEMONIC_BUFF_SIZE];
+
+    for (int i = 0; i < INST_CAPS; ++i) {
+        totl += inst[i];
+    }
+
+    int l = 1 - g_opcs_scroll;
+
+    for (int i = 0; i < INST_CAPS && l < LINES; ++i) {
+        if (!inst[i]) {
+            continue;
+        }
+
+        if (l >= 1) {
+            arch_mnemonic((u8)i, mnem);
+            ui_field(l, PANE_WIDTH, PAIR_LIVE_PROC, A_NORMAL, "%4.2x : %-16s : %#18lx : %7.2f", i, mnem, inst[i], inst[i] * 100.0 / totl);
+        }
+
+        l++;
+    }
+
+    for (; l < LINES; ++l) {
+        if (l >= 1) {
+            move(l, PANE_WIDTH);
+            clrtoeol();
+        }
+    }
+}
+
+void ui_print_opcode(int l) {
+    l++;
+
+    // cores are idle while the UI draws, so their counters may be merged
+    salis_opcs_merge();
+
+    const u64 *evnt = g_opcs_evnt[g_core];
+    u64        totl = 0;
+
+    for (int i = 0; i < INST_CAPS; ++i) {
+        totl += g_opcs_inst[g_core][i];
+    }
+
+    ui_line(true, l++, PAIR_HEADER, A_BOLD, "OPCODE [%#lx]", g_opcs_scroll);
+    ui_ulx_field(l++, "totl", totl);
+    ui_ulx_field(l++, "seek", evnt[OPEV_SEEK]);
+    ui_ulx_field(l++, "allc", evnt[OPEV_ALLC]);
+    ui_ulx_field(l++, "wrte", evnt[OPEV_WRTE]);
+
+    ui_print_opcode_data();
+}
+#endif
+
 void ui_print() {
     int l = 1;
 
     ui_line(false, l++, PAIR_HEADER, A_BOLD, "SALIS [%d:%d]", g_core, CORE_COUNT);
     ui_str_field(l++, "name", SIM_NAME);
+#if INSPECT == 1
+    ui_str_field(l++, "mode", "inspect");
+#endif
     ui_ulx_field(l++, "seed", SEED);
     ui_str_field(l++, "fbit", MUTA_FLIP_BIT ? "yes" : "no");
     ui_ulx_field(l++, "asav", AUTO_SAVE_INTERVAL);
+    ui_ulx_field(l++, "asvb", g_asav_block);
     ui_str_field(l++, "arch", ARCHITECTURE);
     ui_ulx_field(l++, "size", MVEC_SIZE);
     ui_ulx_field(l++, "syni", SYNC_INTERVAL);
     ui_ulx_field(l++, "step", g_steps);
     ui_ulx_field(l++, "sync", g_syncs);
     ui_ulx_field(l++, "step", g_step_block);
+#if REWIND_RING > 0
+    ui_ulx_field(l++, "rwnd", salis_rewind_oldest());
+    ui_ulx_field(l++, "rwsz", salis_rewind_size());
+#endif
 
     switch (g_page) {
     case PAGE_CORE:
@@ -553,6 +833,17 @@ void ui_print() {
     case PAGE_IPC:
         ui_print_ipc(l);
         break;
+    case PAGE_MEMORY:
+        ui_print_memory(l);
+        break;
+    case PAGE_SEARCH:
+        ui_print_search(l);
+        break;
+#if OPCODE_STATS == 1
+    case PAGE_OPCODE:
+        ui_print_opcode(l);
+        break;
+#endif
     default:
         break;
     }
@@ -633,6 +924,48 @@ void ev_vscroll(int ev) {
         }
 
         break;
+    case PAGE_SEARCH:
+        switch (ev) {
+        case 'W':
+            g_srch_scroll += LINES;
+            break;
+        case 'S':
+            g_srch_scroll -= g_srch_scroll < (u64)LINES ? g_srch_scroll : (u64)LINES;
+            break;
+        case 'w':
+            g_srch_scroll += 1;
+            break;
+        case 's':
+            g_srch_scroll -= g_srch_scroll ? 1 : 0;
+            break;
+        case 'q':
+            g_srch_scroll = 0;
+            break;
+        }
+
+        break;
+#if OPCODE_STATS == 1
+    case PAGE_OPCODE:
+        switch (ev) {
+        case 'W':
+            g_opcs_scroll += LINES;
+            break;
+        case 'S':
+            g_opcs_scroll -= g_opcs_scroll < (u64)LINES ? g_opcs_scroll : (u64)LINES;
+            break;
+        case 'w':
+            g_opcs_scroll += 1;
+            break;
+        case 's':
+            g_opcs_scroll -= g_opcs_scroll ? 1 : 0;
+            break;
+        case 'q':
+            g_opcs_scroll = 0;
+            break;
+        }
+
+        break;
+#endif
     default:
         break;
     }
@@ -758,11 +1091,87 @@ void ev_goto_sel_proc() {
     case PAGE_WORLD:
         g_wrld_pos = g_cores[g_core].pvec[g_proc_selected % g_cores[g_core].pcap].mb0a;
         break;
+    case PAGE_SEARCH: {
+        // jumps into the world page, at the scrolled match
+        const Pjob *pjob = &g_srch_jobs[g_core];
+
+        if (g_srch_done && g_srch_scroll < pjob->mnum) {
+            const Pmat *pmat = &pjob->mats[g_srch_scroll];
+
+            clear();
+
+            g_page     = PAGE_WORLD;
+            g_wrld_pos = pmat->addr;
+
+            if (pmat->ownr != PTRN_NONE) {
+                g_proc_selected = pmat->ownr;
+            }
+        }
+
+        break;
+    }
     default:
         break;
     }
 }
 
+// Prompts for a pattern, then searches all cores for it. Results describe
+// the world as it was, so searches must be repeated as it changes.
+void ev_search() {
+    int l = LINES - 1;
+
+    ui_line(true, l, PAIR_HEADER, A_BOLD, "search pattern: ");
+
+    echo();
+    curs_set(1);
+    nodelay(stdscr, false);
+    mvgetnstr(l, 17, g_srch_text, SEARCH_BUFF_LEN - 1);
+    noecho();
+    curs_set(0);
+    clear();
+
+    g_running     = false;
+    g_page        = PAGE_SEARCH;
+    g_srch_scroll = 0;
+    g_srch_step   = g_steps;
+    g_srch_done   = ptrn_parse(&g_srch_ptrn, g_srch_text);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        pjob_free(&g_srch_jobs[i]);
+    }
+
+    if (g_srch_done) {
+        ptrn_search(&g_srch_ptrn, g_cores, g_srch_jobs, SEARCH_LIMIT);
+    }
+}
+
+#if REWIND_RING > 0
+// Prompts for a step to rewind to. The simulation is left paused there.
+void ev_rewind() {
+    char buff[REWIND_BUFF_LEN] = {0};
+    char *end                  = NULL;
+    int   l                    = LINES - 1;
+
+    ui_line(true, l, PAIR_HEADER, A_BOLD, "rewind to step: ");
+
+    echo();
+    curs_set(1);
+    nodelay(stdscr, false);
+    mvgetnstr(l, 17, buff, REWIND_BUFF_LEN - 1);
+    noecho();
+    curs_set(0);
+    clear();
+
+    u64 step = strtoull(buff, &end, 0);
+
+    g_running = false;
+
+    if (end != buff && step <= g_steps) {
+        salis_rewind(step);
+    }
+}
+#endif
+
 void ev_handle() {
     int ev = getch();
 
@@ -844,6 +1253,9 @@ void ev_handle() {
     case 'k':
         ev_goto_sel_proc();
         break;
+    case '/':
+        ev_search();
+        break;
     case 'g':
         if (g_page == PAGE_PROCESS) {
             clear();
@@ -851,6 +1263,14 @@ void ev_handle() {
         }
 
         break;
+#if HEAT_MAPS == 1
+    case 'h':
+        if (g_page == PAGE_WORLD) {
+            g_heat_kind = (g_heat_kind + 1) % (HEAT_COUNT + 1);
+        }
+
+        break;
+#endif
     case 'c':
         if (g_page == PAGE_WORLD) {
             clear();
@@ -863,6 +1283,12 @@ void ev_handle() {
         }
 
         break;
+#if REWIND_RING > 0
+    case 'r':
+        ev_rewind();
+        break;
+#endif
+#if INSPECT == 0
     case ' ':
         g_running = !g_running;
         nodelay(stdscr, g_running);
@@ -883,6 +1309,7 @@ void ev_handle() {
         }
 
         break;
+#endif
     default:
         break;
     }
@@ -911,6 +1338,11 @@ void init() {
     init_pair(PAIR_SELECTED_MB2,    COLOR_BLACK,  COLOR_GREEN  );
     init_pair(PAIR_SELECTED_IP,     COLOR_BLACK,  COLOR_RED    );
     init_pair(PAIR_SELECTED_SP,     COLOR_BLACK,  COLOR_MAGENTA);
+#if HEAT_MAPS == 1
+    init_pair(PAIR_HEAT_LOW,        COLOR_BLACK,  COLOR_GREEN  );
+    init_pair(PAIR_HEAT_MID,        COLOR_BLACK,  COLOR_YELLOW );
+    init_pair(PAIR_HEAT_HIGH,       COLOR_BLACK,  COLOR_RED    );
+#endif
 
 #if ACTION == ACT_NEW
     salis_init();
@@ -918,9 +1350,20 @@ void init() {
     salis_load();
 #endif
 
+#if INSPECT == 1
+    // any stray write into a mapped save now faults, instead of going unseen
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        mprotect(g_cores[i].mvec, MVEC_SIZE, PROT_READ);
+    }
+#endif
+
     g_wrld_zoom  = 1;
     g_step_block = 1;
 
+#if HEAT_MAPS == 1
+    g_heat_kind = HEAT_COUNT;
+#endif
+
     ui_line_buff_resize();
     ui_world_resize();
 }
@@ -941,17 +1384,40 @@ void exec() {
             }
         }
 
+#if PHASE_TIMING == 1
+        u64 rbeg = phase_tsc();
+#endif
+
         ui_print();
+
+#if PHASE_TIMING == 1
+        phase_add(&g_phtm[PHSM_uirn], phase_tsc() - rbeg);
+#endif
+
         ev_handle();
     }
 }
 
 void quit() {
-    gfx_free();
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        pjob_free(&g_srch_jobs[i]);
+    }
+
+    gfx_free(&g_gfx);
     ui_line_buff_free();
+
+#if INSPECT == 1
+    salis_free();
+    endwin();
+#else
     salis_save(SIM_PATH);
+
+    Iost iost = *g_iost_save;
+
     salis_free();
     endwin();
+    salis_iost_print("final save", &iost);
+#endif
 }
 
 int main() {
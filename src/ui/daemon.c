@@ -5,29 +5,366 @@
 /*
  * Implements a minimal UI for the Salis simulator with minimal output and
  * interruptible via OS signals. Ideal for running Salis in the background.
+ *
+ * It may also serve a control socket at '<NAME>.sock', from its own thread.
+ * Clients send one command per line and get one reply line back. Stats are
+ * read from a snapshot, published by the simulator after every step block
+ * under a sequence lock, so the control thread never touches simulation
+ * state. Other commands get posted as requests, picked up by the simulator
+ * between step blocks.
  */
 
 #include <signal.h>
 #include <unistd.h>
 
-volatile bool g_running;
-u64           g_step_block;
+#if DAEMON_CONTROL == 1
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define CTRL_EXTN     ".sock"
+#define CTRL_LINE_LEN (0x100)
+#define CTRL_POLL_MS  (100)
+#define CTRL_IDLE_NS  (10000000)
+
+typedef struct Snap Snap;
+
+// Simulator state, as published after the last step block
+struct Snap {
+    u64  step;
+    u64  sync;
+    u64  blck;
+    u64  untl;
+    u64  rate;  // steps per second, over the last step block
+    u64  asav;
+    bool paus;
+    u64  pnum[CORE_COUNT];
+    u64  mall[CORE_COUNT];
+    u64  ncyc[CORE_COUNT];
+};
+#endif
+
+atomic_bool g_running;
+u64         g_step_block;
+u64         g_asav_seen;
+u64         g_iost_seen;
+
+#if DAEMON_CONTROL == 1
+Snap        g_snap;
+_Atomic u64 g_snap_seqn;
+_Atomic u64 g_ctrl_save;    // saves requested, compared against those done
+u64         g_ctrl_saved;
+_Atomic u64 g_ctrl_blck;    // fixed step block, zero if adaptive
+_Atomic u64 g_ctrl_untl;    // step to pause at, zero if none
+_Atomic u64 g_ctrl_bend;    // step the running block ends at
+atomic_bool g_ctrl_paus;
+atomic_bool g_ctrl_stop;
+int         g_ctrl_sock;
+Thread      g_ctrl_thread;
+u64         g_ctrl_rate;
+#endif
 
 void sig_handler(int signo) {
     switch (signo) {
     case SIGINT:
     case SIGTERM:
         printf("signal received, stopping simulator...\n");
-        g_running = false;
+        atomic_store(&g_running, false);
         break;
     }
 }
 
+#if DAEMON_CONTROL == 1
+// Only ever called from the simulator's thread, so writes never overlap. An
+// odd sequence number tells readers the snapshot is being written.
+void snap_publish() {
+    u64 seqn = atomic_load_explicit(&g_snap_seqn, memory_order_relaxed);
+
+    atomic_store_explicit(&g_snap_seqn, seqn + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    g_snap.step = g_steps;
+    g_snap.sync = g_syncs;
+    g_snap.blck = g_step_block;
+    g_snap.untl = atomic_load(&g_ctrl_untl);
+    g_snap.rate = g_ctrl_rate;
+    g_snap.asav = g_asav_count;
+    g_snap.paus = atomic_load(&g_ctrl_paus);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        g_snap.pnum[i] = g_cores[i].pnum;
+        g_snap.mall[i] = g_cores[i].mall;
+        g_snap.ncyc[i] = g_cores[i].ncyc;
+    }
+
+    atomic_store_explicit(&g_snap_seqn, seqn + 2, memory_order_release);
+}
+
+// Copies the snapshot, retrying whenever it changed while being copied
+void snap_read(Snap *snap) {
+    assert(snap);
+
+    while (true) {
+        u64 seqn = atomic_load_explicit(&g_snap_seqn, memory_order_acquire);
+
+        if (seqn & 1) {
+            thrd_yield();
+            continue;
+        }
+
+        memcpy(snap, &g_snap, sizeof(Snap));
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&g_snap_seqn, memory_order_relaxed) == seqn) {
+            return;
+        }
+    }
+}
+
+// Writes the reply to a single command into 'rply'
+void ctrl_command(char *line, char *rply) {
+    assert(line);
+    assert(rply);
+
+    char *save = NULL;
+    char *cmnd = strtok_r(line, " \t\r\n", &save);
+    char *argm = strtok_r(NULL, " \t\r\n", &save);
+    char *end  = NULL;
+    u64   valu = argm ? strtoull(argm, &end, 0) : 0;
+    bool  vald = argm && end != argm && !*end;
+
+    if (!cmnd || !strcmp(cmnd, "help")) {
+        snprintf(rply, CTRL_LINE_LEN, "commands: stats, core N, save, pause, resume, block N (0 adapts), until STEP, stop\n");
+    } else if (!strcmp(cmnd, "stats")) {
+        Snap snap;
+        u64  pnum = 0;
+        u64  mall = 0;
+
+        snap_read(&snap);
+
+        for (int i = 0; i < CORE_COUNT; ++i) {
+            pnum += snap.pnum[i];
+            mall += snap.mall[i];
+        }
+
+        snprintf(
+            rply,
+            CTRL_LINE_LEN,
+            "step %#lx sync %#lx block %#lx rate %lu %s until %#lx asav %#lx pnum %#lx mall %#lx\n",
+            snap.step,
+            snap.sync,
+            snap.blck,
+            snap.rate,
+            snap.paus ? "paused" : "running",
+            snap.untl,
+            snap.asav,
+            pnum,
+            mall
+        );
+    } else if (!strcmp(cmnd, "core") && vald && valu < CORE_COUNT) {
+        Snap snap;
+
+        snap_read(&snap);
+        snprintf(
+            rply,
+            CTRL_LINE_LEN,
+            "core %lu pnum %#lx mall %#lx ncyc %#lx\n",
+            valu,
+            snap.pnum[valu],
+            snap.mall[valu],
+            snap.ncyc[valu]
+        );
+    } else if (!strcmp(cmnd, "save")) {
+        atomic_fetch_add(&g_ctrl_save, 1);
+        snprintf(rply, CTRL_LINE_LEN, "ok, saving after this step block\n");
+    } else if (!strcmp(cmnd, "pause")) {
+        atomic_store(&g_ctrl_paus, true);
+        snprintf(rply, CTRL_LINE_LEN, "ok, pausing after this step block\n");
+    } else if (!strcmp(cmnd, "resume")) {
+        atomic_store(&g_ctrl_paus, false);
+        snprintf(rply, CTRL_LINE_LEN, "ok\n");
+    } else if (!strcmp(cmnd, "block") && vald) {
+        atomic_store(&g_ctrl_blck, valu);
+        snprintf(rply, CTRL_LINE_LEN, "ok\n");
+    } else if (!strcmp(cmnd, "until") && vald) {
+        u64 bend = atomic_load(&g_ctrl_bend);
+
+        // later steps are always seen before the block reaching them starts
+        if (valu <= bend) {
+            snprintf(rply, CTRL_LINE_LEN, "error, simulator already running up to step %#lx\n", bend);
+        } else {
+            atomic_store(&g_ctrl_untl, valu);
+            atomic_store(&g_ctrl_paus, false);
+            snprintf(rply, CTRL_LINE_LEN, "ok\n");
+        }
+    } else if (!strcmp(cmnd, "stop")) {
+        atomic_store(&g_running, false);
+        snprintf(rply, CTRL_LINE_LEN, "ok, stopping simulator\n");
+    } else {
+        snprintf(rply, CTRL_LINE_LEN, "error, unknown command (try 'help')\n");
+    }
+}
+
+// Serves a single client until it hangs up, or the daemon stops
+void ctrl_serve(int conn) {
+    char line[CTRL_LINE_LEN];
+    char rply[CTRL_LINE_LEN];
+    u64  size = 0;
+
+    while (!atomic_load(&g_ctrl_stop)) {
+        struct pollfd pfd = { .fd = conn, .events = POLLIN };
+
+        if (poll(&pfd, 1, CTRL_POLL_MS) <= 0) {
+            continue;
+        }
+
+        ssize_t rcvd = recv(conn, &line[size], CTRL_LINE_LEN - 1 - size, 0);
+
+        if (rcvd <= 0) {
+            return;
+        }
+
+        size += (u64)rcvd;
+
+        // over long lines get handled as a whole, once the buffer fills up
+        for (char *nlin; (nlin = memchr(line, '\n', size)) || size == CTRL_LINE_LEN - 1;) {
+            u64 llen = nlin ? (u64)(nlin - line) + 1 : size;
+
+            line[llen - 1] = '\0';
+
+            ctrl_command(line, rply);
+
+            if (send(conn, rply, strlen(rply), MSG_NOSIGNAL) < 0) {
+                return;
+            }
+
+            memmove(line, &line[llen], size - llen);
+
+            size -= llen;
+        }
+    }
+}
+
+int ctrl_run(void *data) {
+    (void)data;
+
+    while (!atomic_load(&g_ctrl_stop)) {
+        struct pollfd pfd = { .fd = g_ctrl_sock, .events = POLLIN };
+
+        if (poll(&pfd, 1, CTRL_POLL_MS) <= 0) {
+            continue;
+        }
+
+        int conn = accept(g_ctrl_sock, NULL, NULL);
+
+        if (conn < 0) {
+            continue;
+        }
+
+        ctrl_serve(conn);
+        close(conn);
+    }
+
+    return 0;
+}
+
+void ctrl_init() {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+
+    assert(strlen(SIM_PATH CTRL_EXTN) < sizeof(addr.sun_path));
+
+    strcpy(addr.sun_path, SIM_PATH CTRL_EXTN);
+    unlink(SIM_PATH CTRL_EXTN);
+
+    g_ctrl_sock = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    assert(g_ctrl_sock >= 0);
+
+    if (bind(g_ctrl_sock, (struct sockaddr *)&addr, sizeof(addr)) || listen(g_ctrl_sock, 4)) {
+        perror("cannot serve control socket");
+        exit(EXIT_FAILURE);
+    }
+
+    atomic_store(&g_ctrl_bend, g_steps);
+    snap_publish();
+    thrd_create(&g_ctrl_thread, ctrl_run, NULL);
+
+    printf("serving control socket at '%s'\n", SIM_PATH CTRL_EXTN);
+}
+
+void ctrl_free() {
+    atomic_store(&g_ctrl_stop, true);
+    thrd_join(g_ctrl_thread, NULL);
+    close(g_ctrl_sock);
+    unlink(SIM_PATH CTRL_EXTN);
+}
+
+// Handles requests posted by the control thread. Returns false while the
+// simulator is paused, idling the calling thread for a while.
+bool ctrl_handle() {
+    u64 save = atomic_load(&g_ctrl_save);
+
+    if (save != g_ctrl_saved) {
+        g_ctrl_saved = save;
+
+        salis_save_async(SIM_PATH, false);
+        printf("save requested, blocked simulator for %.3f ms\n", g_asav_block / 1e6);
+    }
+
+    if (atomic_load(&g_ctrl_paus)) {
+        snap_publish();
+        thrd_sleep(&(struct timespec){ .tv_nsec = CTRL_IDLE_NS }, NULL);
+
+        return false;
+    }
+
+    return true;
+}
+#endif
+
 void step_block() {
+    u64 ns = g_step_block - (g_steps % g_step_block);
+
+#if DAEMON_CONTROL == 1
+    u64 blck = atomic_load(&g_ctrl_blck);
+
+    if (blck) {
+        g_step_block = blck;
+        ns           = blck - (g_steps % blck);
+    }
+
+    // published before the requested step is read, so the control thread
+    // either sees the block's end or gets its step seen here
+    atomic_store(&g_ctrl_bend, g_steps + ns);
+
+    u64 untl = atomic_load(&g_ctrl_untl);
+
+    assert(!untl || untl > g_steps);
+
+    // blocks get cut short, so the requested step is never stepped over
+    if (untl && untl - g_steps < ns) {
+        ns = untl - g_steps;
+
+        atomic_store(&g_ctrl_bend, untl);
+    }
+
+    u64 nbeg = salis_clock_ns();
+#endif
+
     clock_t beg = clock();
-    salis_step(g_step_block - (g_steps % g_step_block));
+    salis_step(ns);
     clock_t end = clock();
 
+#if DAEMON_CONTROL == 1
+    g_ctrl_rate = (u64)(ns * 1e9 / (salis_clock_ns() - nbeg + 1));
+
+    if (untl && g_steps >= untl) {
+        printf("reached step '%#lx', pausing simulator\n", untl);
+        atomic_store(&g_ctrl_untl, 0);
+        atomic_store(&g_ctrl_paus, true);
+    }
+#endif
+
     if ((end - beg) < (CLOCKS_PER_SEC * 4)) {
         g_step_block <<= 1;
     }
@@ -36,7 +373,42 @@ void step_block() {
         g_step_block >>= 1;
     }
 
+#if DAEMON_CONTROL == 1
+    // fixed blocks override adaptation
+    if (blck) {
+        g_step_block = blck;
+    }
+
+    snap_publish();
+#endif
+
     printf("simulator running on step '%#lx'\n", g_steps);
+    salis_sbar_report();
+    salis_mems_report();
+
+#if GENOME_CENSUS == 1
+    salis_cens_report();
+#endif
+
+    if (g_asav_count != g_asav_seen) {
+        g_asav_seen = g_asav_count;
+
+        printf(
+            "auto-save #%#lx blocked simulator for %.3f ms (%.3f ms total)\n",
+            g_asav_count,
+            g_asav_block / 1e6,
+            g_asav_block_total / 1e6
+        );
+
+#if HEAT_MAPS == 1
+        salis_heat_write();
+#endif
+    }
+
+    if (g_iost_save->count != g_iost_seen) {
+        g_iost_seen = g_iost_save->count;
+        salis_iost_print("last save", g_iost_save);
+    }
 }
 
 int main() {
@@ -44,19 +416,62 @@ int main() {
     salis_init();
 #elif ACTION == ACT_LOAD
     salis_load();
+    salis_iost_print("loaded", &g_iost_load);
 #endif
 
-    g_running    = true;
+    atomic_store(&g_running, true);
+
     g_step_block = 1;
 
     signal(SIGINT,  sig_handler);
     signal(SIGTERM, sig_handler);
 
-    while (g_running) {
+#if DAEMON_CONTROL == 1
+    ctrl_init();
+
+    while (atomic_load(&g_running)) {
+        if (ctrl_handle()) {
+            step_block();
+        }
+    }
+
+    ctrl_free();
+#else
+    while (atomic_load(&g_running)) {
         step_block();
     }
+#endif
+
+    salis_sbar_print();
+    salis_mems_print();
+
+#if OPCODE_STATS == 1
+    salis_opcs_print();
+#endif
+
+#if HEAT_MAPS == 1
+    salis_heat_print();
+    salis_heat_write();
+#endif
+
+#if GENOME_CENSUS == 1
+    salis_cens_print();
+#endif
+
+#if PHASE_TIMING == 1
+    salis_phase_print();
+#endif
+
+    u64 beg = salis_clock_ns();
+    salis_save_async(SIM_PATH, false);
+    printf("final save started, blocked for %.3f ms\n", g_asav_block / 1e6);
+
+    // the launcher may remove the binary and let the simulation be reloaded
+    // right after we return, so the background writer must finish first
+    salis_save_wait();
+    printf("final save written after %.3f ms\n", (salis_clock_ns() - beg) / 1e6);
+    salis_iost_print("final save", g_iost_save);
 
-    salis_save(SIM_PATH);
     salis_free();
 
     return 0;
@@ -0,0 +1,300 @@
+// Project: Salis
+// Author:  Paul Oliver
+// Email:   contact@pauloliver.dev
+
+/*
+ * Implements a headless UI which exports time-lapse frames of the simulated
+ * worlds, as binary PPM images, every FRAME_INTERVAL steps. Each frame shows
+ * all cores stacked vertically, each one as a band of FRAME_WIDTH by
+ * FRAME_HEIGHT pixels, zoomed out so that the whole memory vector fits. Like
+ * auto-saves, every frame is rendered (each core's band on its own thread,
+ * through the regular graphics module) and written by a forked child, which
+ * gets a copy-on-write snapshot of the cores for free, while the simulation
+ * keeps going. The simulation only blocks for the fork, and only pages it
+ * writes to while a frame is in flight get duplicated. Like the daemon UI, it
+ * is interruptible via OS signals.
+ */
+
+#include <signal.h>
+#include <unistd.h>
+
+#define FRAME_EXTN   ".frames"
+#define FRAME_QUEUE  (2)    // frames in flight, before stepping blocks
+#define FRAME_PIXELS (FRAME_WIDTH * FRAME_HEIGHT)
+#define FRAME_ZOOM   ((MVEC_SIZE + FRAME_PIXELS - 1) / FRAME_PIXELS)
+#define FRAME_BAND   (FRAME_PIXELS * 3)
+
+typedef struct Band Band;
+typedef struct Fjob Fjob;
+
+// Renders a single core of a frame
+struct Band {
+    Fjob  *fjob;
+    int    cix;
+    Thread thread;
+};
+
+// Renders and writes a single frame, from the writer's copy of the cores
+struct Fjob {
+    u8    *pixl;
+    u64    step;
+    pid_t  pid;
+    Band   band[CORE_COUNT];
+};
+
+volatile bool g_running;
+u64           g_step_block;
+u64           g_asav_seen;
+u64           g_iost_seen;
+u64           g_fram_count;
+u64           g_fram_block;
+Fjob          g_fjobs[FRAME_QUEUE];
+int           g_fjob_next;
+
+#include "graphics.c"
+
+void sig_handler(int signo) {
+    switch (signo) {
+    case SIGINT:
+    case SIGTERM:
+        printf("signal received, stopping simulator...\n");
+        g_running = false;
+        break;
+    }
+}
+
+// Allocation state sets the hue (free cells blue, allocated cells cyan and
+// block starts white), while the average byte value sets the brightness
+void band_pixel(const Gfx *gfx, u64 i, u8 *rgb) {
+    assert(gfx);
+    assert(i < gfx->vsiz);
+    assert(rgb);
+
+    if (i * FRAME_ZOOM >= MVEC_SIZE) {
+        rgb[0] = rgb[1] = rgb[2] = 0;
+        return;
+    }
+
+    u64 shde = 0x80 + ((gfx->inst[i] / FRAME_ZOOM) & 0xff) / 2;
+    u64 mall = gfx->mbst[i] ? FRAME_ZOOM : gfx->mall[i];
+
+    rgb[0] = gfx->mbst[i] ? (u8)shde : 0;
+    rgb[1] = (u8)(shde * mall / FRAME_ZOOM);
+    rgb[2] = (u8)shde;
+}
+
+int band_render(Band *band) {
+    assert(band);
+
+    Fjob *fjob = band->fjob;
+    u8   *pixl = &fjob->pixl[FRAME_BAND * band->cix];
+    Gfx   gfx  = {0};
+
+    // no process is selected, so only the unselected channels light up
+    gfx_init(&gfx, FRAME_PIXELS);
+    gfx_render(&gfx, &g_cores[band->cix], 0, FRAME_ZOOM, (u64)-1);
+
+    for (u64 i = 0; i < FRAME_PIXELS; ++i) {
+        band_pixel(&gfx, i, &pixl[i * 3]);
+    }
+
+    gfx_free(&gfx);
+
+    return 0;
+}
+
+// Returns false if the frame could not be written
+bool fjob_run(Fjob *fjob) {
+    assert(fjob);
+
+    fjob->pixl = malloc(FRAME_BAND * CORE_COUNT);
+
+    assert(fjob->pixl);
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        fjob->band[i].fjob = fjob;
+        fjob->band[i].cix  = i;
+        thrd_create(&fjob->band[i].thread, (thrd_start_t)band_render, &fjob->band[i]);
+    }
+
+    for (int i = 0; i < CORE_COUNT; ++i) {
+        thrd_join(fjob->band[i].thread, NULL);
+    }
+
+    char path[AUTO_SAVE_NAME_LEN];
+
+    snprintf(path, AUTO_SAVE_NAME_LEN, "%s/%#018lx.ppm", SIM_PATH FRAME_EXTN, fjob->step);
+
+    FILE *f    = fopen(path, "wb");
+    bool  fail = !f;
+
+    if (f) {
+        fprintf(f, "P6\n%lu %lu\n255\n", FRAME_WIDTH, FRAME_HEIGHT * CORE_COUNT);
+        fwrite(fjob->pixl, sizeof(u8), FRAME_BAND * CORE_COUNT, f);
+
+        fail |= ferror(f) != 0;
+        fail |= fclose(f) != 0;
+    }
+
+    free(fjob->pixl);
+
+    fjob->pixl = NULL;
+
+    return !fail;
+}
+
+void fjob_wait(Fjob *fjob) {
+    assert(fjob);
+
+    if (!fjob->pid) {
+        return;
+    }
+
+    int status = 0;
+
+    waitpid(fjob->pid, &status, 0);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "cannot write frame at step '%#lx'\n", fjob->step);
+    }
+
+    fjob->pid = 0;
+}
+
+void frame_init() {
+    mkdir(SIM_PATH FRAME_EXTN, 0755);
+}
+
+void frame_free() {
+    for (int i = 0; i < FRAME_QUEUE; ++i) {
+        fjob_wait(&g_fjobs[i]);
+    }
+}
+
+// Forks a writer for the frame, rendering it right away (while the simulator
+// waits) if forking fails, under the same glibc assumption as auto-saves. The
+// simulator only blocks for the fork, or when all writers are still busy with
+// older frames.
+void frame_take() {
+    u64   beg  = salis_clock_ns();
+    Fjob *fjob = &g_fjobs[g_fjob_next];
+
+#if PHASE_TIMING == 1
+    u64 rbeg = phase_tsc();
+#endif
+
+    fjob_wait(fjob);
+
+    fjob->step = g_steps;
+
+#ifdef __GLIBC__
+    pid_t pid = fork();
+#else
+    pid_t pid = -1;
+#endif
+
+    if (pid == 0) {
+        _exit(fjob_run(fjob) ? 0 : 1);
+    }
+
+    if (pid == -1 && !fjob_run(fjob)) {
+        fprintf(stderr, "cannot write frame at step '%#lx'\n", fjob->step);
+    }
+
+    fjob->pid = pid == -1 ? 0 : pid;
+
+    g_fjob_next   = (g_fjob_next + 1) % FRAME_QUEUE;
+    g_fram_block += salis_clock_ns() - beg;
+    g_fram_count++;
+
+#if PHASE_TIMING == 1
+    phase_add(&g_phtm[PHSM_uirn], phase_tsc() - rbeg);
+#endif
+}
+
+void step_block() {
+    clock_t beg = clock();
+    salis_step(g_step_block - (g_steps % g_step_block));
+    clock_t end = clock();
+
+    // blocks are powers of two, never larger than the frame interval, so
+    // they never step past a frame
+    if ((end - beg) < (CLOCKS_PER_SEC * 4) && g_step_block < FRAME_INTERVAL) {
+        g_step_block <<= 1;
+    }
+
+    if ((end - beg) >= (CLOCKS_PER_SEC * 2) && g_step_block != 1) {
+        g_step_block >>= 1;
+    }
+
+    printf("simulator running on step '%#lx'\n", g_steps);
+
+    if (g_steps % FRAME_INTERVAL == 0) {
+        frame_take();
+
+        printf(
+            "frame #%#lx taken at step '%#lx', frames blocked simulator for %.3f ms total\n",
+            g_fram_count,
+            g_steps,
+            g_fram_block / 1e6
+        );
+    }
+
+    if (g_asav_count != g_asav_seen) {
+        g_asav_seen = g_asav_count;
+
+        printf(
+            "auto-save #%#lx blocked simulator for %.3f ms (%.3f ms total)\n",
+            g_asav_count,
+            g_asav_block / 1e6,
+            g_asav_block_total / 1e6
+        );
+    }
+
+    if (g_iost_save->count != g_iost_seen) {
+        g_iost_seen = g_iost_save->count;
+        salis_iost_print("last save", g_iost_save);
+    }
+}
+
+int main() {
+#if ACTION == ACT_NEW
+    salis_init();
+#elif ACTION == ACT_LOAD
+    salis_load();
+    salis_iost_print("loaded", &g_iost_load);
+#endif
+
+    g_running    = true;
+    g_step_block = 1;
+
+    signal(SIGINT,  sig_handler);
+    signal(SIGTERM, sig_handler);
+
+    frame_init();
+
+    if (g_steps % FRAME_INTERVAL == 0) {
+        frame_take();
+    }
+
+    while (g_running) {
+        step_block();
+    }
+
+    frame_free();
+    printf("%#lx frames written to '%s'\n", g_fram_count, SIM_PATH FRAME_EXTN);
+
+    u64 beg = salis_clock_ns();
+    salis_save_async(SIM_PATH, false);
+    printf("final save started, blocked for %.3f ms\n", g_asav_block / 1e6);
+
+    // the launcher may remove the binary and let the simulation be reloaded
+    // right after we return, so the background writer must finish first
+    salis_save_wait();
+    printf("final save written after %.3f ms\n", (salis_clock_ns() - beg) / 1e6);
+    salis_iost_print("final save", g_iost_save);
+
+    salis_free();
+
+    return 0;
+}